@@ -0,0 +1,197 @@
+#pragma once
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "../Models/Project_path.h"
+
+#ifdef __APPLE__
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#else
+#include <SDL.h>
+#include <SDL_image.h>
+#endif
+
+// С флагом EMBED_TEXTURES картинки берутся из программы, а не из папки Textures
+// Файл с ними создает команда "cli embed"
+#ifdef EMBED_TEXTURES
+#include "../Textures/embedded_textures.h"
+#endif
+
+using namespace std;
+
+// Спрайты атласа
+enum class Sprite
+{
+    WHITE_PIECE,
+    BLACK_PIECE,
+    WHITE_QUEEN,
+    BLACK_QUEEN,
+    BACK,   // Кнопка "Назад"
+    REPLAY, // Кнопка "Повторить игру"
+    COUNT
+};
+
+// Текстуры игры: фон доски, атлас спрайтов и кэш картинок с результатом партии
+// Все спрайты, которые рисуются в каждом кадре, лежат в одной текстуре: картинки декодируются один раз
+// при запуске, а кадр рисуется из одной текстуры без переключений
+class Assets
+{
+  public:
+    Assets() = default;
+    Assets(const Assets &) = delete;
+    Assets &operator=(const Assets &) = delete;
+    ~Assets()
+    {
+        clear();
+    }
+
+    // Загрузка фона доски и сборка атласа, false при ошибке (имя файла в failed)
+    bool load(SDL_Renderer *ren)
+    {
+        clear();
+        renderer = ren;
+        SDL_Surface *board_surface = load_surface(BOARD_FILE);
+        if (board_surface == nullptr)
+            return false;
+        board = SDL_CreateTextureFromSurface(ren, board_surface);
+        SDL_FreeSurface(board_surface);
+        if (board == nullptr)
+        {
+            failed = BOARD_FILE;
+            return false;
+        }
+        return build_atlas();
+    }
+
+    SDL_Texture *board_texture() const
+    {
+        return board;
+    }
+
+    SDL_Texture *atlas_texture() const
+    {
+        return atlas;
+    }
+
+    // Место спрайта в атласе
+    const SDL_Rect *rect(const Sprite sprite) const
+    {
+        return &rects[int(sprite)];
+    }
+
+    // Картинка результата партии: 0 - ничья, 1 - победа белых, 2 - победа черных
+    // Загружается при первом показе и дальше берется из кэша, nullptr если загрузить не удалось
+    SDL_Texture *result(const int res)
+    {
+        if (!result_loaded[res])
+        {
+            result_loaded[res] = true;
+            SDL_Surface *surface = load_surface(RESULT_FILES[res]);
+            if (surface != nullptr)
+            {
+                results[res] = SDL_CreateTextureFromSurface(renderer, surface);
+                SDL_FreeSurface(surface);
+            }
+        }
+        return results[res];
+    }
+
+    // Освобождение всех текстур
+    void clear()
+    {
+        SDL_DestroyTexture(board);
+        SDL_DestroyTexture(atlas);
+        board = atlas = nullptr;
+        for (int i = 0; i < 3; ++i)
+        {
+            SDL_DestroyTexture(results[i]);
+            results[i] = nullptr;
+            result_loaded[i] = false;
+        }
+    }
+
+    string failed; // Файл, который не удалось загрузить
+
+  private:
+    static constexpr const char *BOARD_FILE = "board.png";
+    static constexpr const char *SPRITE_FILES[int(Sprite::COUNT)] = {
+        "piece_white.png", "piece_black.png", "queen_white.png", "queen_black.png", "back.png", "replay.png"};
+    static constexpr const char *RESULT_FILES[3] = {"draw.png", "white_wins.png", "black_wins.png"};
+    static const int ATLAS_MAX_WIDTH = 4096; // Размер текстуры, который поддерживают практически все видеокарты
+    static const int ATLAS_PADDING = 2;      // Зазор между спрайтами, чтобы при масштабировании не смешивались края
+
+    // Декодирование картинки из папки Textures или из программы
+    SDL_Surface *load_surface(const string &name)
+    {
+#ifdef EMBED_TEXTURES
+        SDL_Surface *surface = nullptr;
+        for (const auto &texture : EMBEDDED_TEXTURES)
+            if (name == texture.name)
+                surface = IMG_Load_RW(SDL_RWFromConstMem(texture.data, int(texture.size)), 1);
+#else
+        SDL_Surface *surface = IMG_Load((project_path + "Textures/" + name).c_str());
+#endif
+        if (surface == nullptr)
+            failed = name;
+        return surface;
+    }
+
+    // Сборка атласа: спрайты раскладываются полками по убыванию высоты и копируются в одну картинку
+    bool build_atlas()
+    {
+        const int count = int(Sprite::COUNT);
+        vector<SDL_Surface *> surfaces(count, nullptr);
+        bool ok = true;
+        for (int i = 0; i < count && ok; ++i)
+            ok = (surfaces[i] = load_surface(SPRITE_FILES[i])) != nullptr;
+        if (ok)
+        {
+            vector<int> order(count);
+            for (int i = 0; i < count; ++i)
+                order[i] = i;
+            sort(order.begin(), order.end(), [&](const int a, const int b) { return surfaces[a]->h > surfaces[b]->h; });
+            int x = 0, y = 0, shelf = 0, width = 0;
+            for (const int i : order)
+            {
+                if (x + surfaces[i]->w > ATLAS_MAX_WIDTH) // Полка заполнена, начинаем следующую
+                {
+                    x = 0;
+                    y += shelf + ATLAS_PADDING;
+                    shelf = 0;
+                }
+                rects[i] = SDL_Rect{x, y, surfaces[i]->w, surfaces[i]->h};
+                x += surfaces[i]->w + ATLAS_PADDING;
+                shelf = max(shelf, surfaces[i]->h);
+                width = max(width, x);
+            }
+            SDL_Surface *sheet = SDL_CreateRGBSurfaceWithFormat(0, width, y + shelf, 32, SDL_PIXELFORMAT_RGBA32);
+            ok = sheet != nullptr;
+            for (int i = 0; i < count && ok; ++i)
+            {
+                SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE); // Копируем прозрачность, а не смешиваем
+                SDL_Rect place = rects[i]; // SDL_BlitSurface может изменить прямоугольник
+                ok = SDL_BlitSurface(surfaces[i], nullptr, sheet, &place) == 0;
+            }
+            if (ok)
+            {
+                atlas = SDL_CreateTextureFromSurface(renderer, sheet);
+                ok = atlas != nullptr;
+            }
+            if (!ok)
+                failed = "texture atlas";
+            SDL_FreeSurface(sheet);
+        }
+        for (auto surface : surfaces)
+            SDL_FreeSurface(surface);
+        return ok;
+    }
+
+    SDL_Renderer *renderer = nullptr;
+    SDL_Texture *board = nullptr; // Фон доски рисуется только в статический слой, поэтому хранится отдельно
+    SDL_Texture *atlas = nullptr;
+    SDL_Rect rects[int(Sprite::COUNT)] = {};
+    SDL_Texture *results[3] = {nullptr, nullptr, nullptr};
+    bool result_loaded[3] = {false, false, false};
+};
@@ -0,0 +1,101 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../Models/Position.h"
+#include "MappedFile.h"
+#include "TTable.h"
+
+using namespace std;
+
+// Дебютная книга: отсортированный по ключу позиции массив записей "позиция, позиция после хода, вес"
+// Ход хранится как ключ позиции после него, поэтому серия взятий записывается так же, как простой ход
+// Файл: 8 байт сигнатуры BOOK_MAGIC, затем записи book_entry; файл отображается в память, поиск двоичный
+struct book_entry
+{
+    uint64_t key;    // Ключ позиции с очередью хода
+    uint64_t next;   // Ключ позиции после хода
+    uint64_t weight; // Вес хода (чем больше, тем чаще он выбирается)
+};
+
+const char BOOK_MAGIC[8] = {'C', 'H', 'K', 'B', 'O', 'O', 'K', '1'};
+
+// Ключ позиции для книги: позиция и очередь хода
+inline uint64_t book_key(const Position &mtx, const bool color)
+{
+    return zobrist_hash(mtx) ^ (color ? ZOBRIST.side : 0);
+}
+
+class Book
+{
+  public:
+    // Книга из файла path, пустая при отсутствии файла или неверном формате
+    explicit Book(const string &path) : file(make_unique<MappedFile>(path))
+    {
+        if (!file->data || file->size < sizeof(BOOK_MAGIC) || memcmp(file->data, BOOK_MAGIC, sizeof(BOOK_MAGIC)) ||
+            (file->size - sizeof(BOOK_MAGIC)) % sizeof(book_entry))
+            return;
+        entries = reinterpret_cast<const book_entry *>(file->data + sizeof(BOOK_MAGIC));
+        count = (file->size - sizeof(BOOK_MAGIC)) / sizeof(book_entry);
+    }
+
+    // Записи позиции key: пара указателей [first, last)
+    pair<const book_entry *, const book_entry *> probe(const uint64_t key) const
+    {
+        const book_entry *first =
+            lower_bound(entries, entries + count, key, [](const book_entry &e, uint64_t k) { return e.key < k; });
+        const book_entry *last = first;
+        while (last != entries + count && last->key == key)
+            ++last;
+        return {first, last};
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+  private:
+    unique_ptr<MappedFile> file;
+    const book_entry *entries = nullptr;
+    size_t count = 0;
+};
+
+// Сбор весов ходов (например, из партий бота с самим собой) и запись книги в файл
+class BookBuilder
+{
+  public:
+    void add(const uint64_t key, const uint64_t next, const uint64_t weight)
+    {
+        weights[{key, next}] += weight;
+    }
+
+    // Запись книги, ходы с нулевым весом не сохраняются; возвращает число записей или -1 при ошибке
+    long long save(const string &path) const
+    {
+        ofstream fout(path, ios::binary | ios::trunc);
+        if (!fout)
+            return -1;
+        fout.write(BOOK_MAGIC, sizeof(BOOK_MAGIC));
+        long long count = 0;
+        for (const auto &w : weights) // map уже упорядочен по ключу позиции
+        {
+            if (!w.second)
+                continue;
+            const book_entry entry{w.first.first, w.first.second, w.second};
+            fout.write(reinterpret_cast<const char *>(&entry), sizeof(entry));
+            ++count;
+        }
+        return fout ? count : -1;
+    }
+
+  private:
+    map<pair<uint64_t, uint64_t>, uint64_t> weights;
+};
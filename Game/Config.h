@@ -1,23 +1,40 @@
 #pragma once
 #include <fstream>
+#include <string>
 #include <nlohmann/json.hpp>
 using json = nlohmann::json;
+using namespace std;
 
 #include "../Models/Project_path.h"
 
+// Конфигурация не зависит от SDL2 и используется как игрой, так и консольной программой (cli.cpp)
 class Config
 {
   public:
-    Config() // Конструктор класса Config.
+    Config() : Config(project_path + "settings.json") // Конструктор класса Config.
+    {
+    }
+
+    explicit Config(const string &path) : path(path) // Конфигурация из заданного файла настроек.
     {
         reload(); // Вызов метода reload() при создании объекта для загрузки начальной конфигурации.
     }
 
     void reload() // Метод для перезагрузки конфигурационных данных из файла.
     {
-        std::ifstream fin(project_path + "settings.json");
+        std::ifstream fin(path);
         fin >> config;
         fin.close();
+        config.merge_patch(overrides); // Значения, заданные флагами, важнее значений из файла
+    }
+
+    // Переопределение настройки (например, флагом --Bot.BotTimeMS=100), сохраняется при перезагрузке
+    // Значение разбирается как JSON (числа, true/false), иначе считается строкой
+    void set(const string &setting_dir, const string &setting_name, const string &value)
+    {
+        json parsed = json::parse(value, nullptr, false);
+        overrides[setting_dir][setting_name] = parsed.is_discarded() ? json(value) : parsed;
+        config[setting_dir][setting_name] = overrides[setting_dir][setting_name];
     }
 
     auto operator()(const string &setting_dir, const string &setting_name) const
@@ -27,5 +44,7 @@ class Config
     }
 
   private:
+    string path; // Путь к файлу настроек
     json config;
-};
+    json overrides = json::object(); // Настройки, переопределенные флагами
+};
\ No newline at end of file
@@ -1,20 +1,26 @@
 #pragma once
+#include <atomic>
 #include <chrono>
+#include <memory>
 #include <thread>
 
+#include "../Models/Notation.h"
 #include "../Models/Project_path.h"
 #include "Board.h"
 #include "Config.h"
 #include "Hand.h"
+#include "Logger.h"
 #include "Logic.h"
+#include "SearchWorker.h"
 
 class Game
 {
   public:
-    Game() : board(config("WindowSize", "Width"), config("WindowSize", "Hight")), hand(&board), logic(&board, &config)
+    Game()
+        : logger(project_path + "log.txt", size_t(int(config("Game", "LogMaxSizeKB"))) * 1024,
+                 config("Game", "LogFiles")),
+          board(config("WindowSize", "Width"), config("WindowSize", "Hight"), &logger), hand(&board), logic(&config)
     {
-        ofstream fout(project_path + "log.txt", ios_base::trunc);
-        fout.close();
     }
 
     // Функция для запуска игры в шашки
@@ -23,7 +29,8 @@ class Game
         auto start = chrono::steady_clock::now(); // Запоминаем время начала игры
         if (is_replay) // Если это повторная игра (например, после отката хода)
         {
-            logic = Logic(&board, &config); // Пересоздаем объект логики игры
+            searcher.cancel(); // Поток поиска не должен работать со старой логикой
+            logic = Logic(&config); // Пересоздаем объект логики игры
             config.reload(); // Перезагружаем конфигурацию из файла
             board.redraw(); // Перерисовываем доску
         }
@@ -39,13 +46,19 @@ class Game
         while (++turn_num < Max_turns) // Цикл по всем ходам до достижения максимального количества ходов
         {
             beat_series = 0; // Сброс серии взятий
-            logic.find_turns(turn_num % 2); // Находим возможные ходы для текущего игрока (0 - белые, 1 - черные)
+            board.present(); // Показываем позицию до начала хода (бот может думать долго)
+            logic.find_turns(turn_num % 2, board.get_board()); // Находим возможные ходы для текущего игрока (0 - белые, 1 - черные)
             if (logic.turns.empty()) // Если нет доступных ходов, завершаем игру
                 break;
             logic.Max_depth = config("Bot", string((turn_num % 2) ? "Black" : "White") + string("BotLevel")); // Устанавливаем глубину поиска для бота
             if (!config("Bot", string("Is") + string((turn_num % 2) ? "Black" : "White") + string("Bot"))) // Если текущий игрок не бот
             {
+                // Пока игрок думает, бот-соперник ищет позиции после его возможных ответов
+                if (config("Bot", "Ponder") &&
+                    config("Bot", string("Is") + string((1 - turn_num % 2) ? "Black" : "White") + string("Bot")))
+                    start_ponder(1 - turn_num % 2);
                 auto resp = player_turn(turn_num % 2); // Выполняем ход игрока
+                stop_ponder(); // Игрок сходил: фоновый поиск останавливаем, его результаты уже в таблице
                 if (resp == Response::QUIT) // Если игрок выбрал выход
                 {
                     is_quit = true;
@@ -59,7 +72,7 @@ class Game
                 else if (resp == Response::BACK) // Если игрок выбрал откат хода
                 {
                     if (config("Bot", string("Is") + string((1 - turn_num % 2) ? "Black" : "White") + string("Bot")) &&
-                        !beat_series && board.history_mtx.size() > 2)
+                        !beat_series && board.journal.size() > 1)
                     {
                         board.rollback(); // Откатываем ход
                         --turn_num; // Уменьшаем номер хода
@@ -73,12 +86,28 @@ class Game
                 }
             }
             else
-                bot_turn(turn_num % 2); // Выполняем ход бота
+            {
+                auto resp = bot_turn(turn_num % 2); // Выполняем ход бота
+                if (resp == Response::QUIT) // Игрок закрыл окно, пока бот думал
+                {
+                    is_quit = true;
+                    break;
+                }
+                else if (resp == Response::REPLAY) // Игрок начал игру заново, пока бот думал
+                {
+                    is_replay = true;
+                    break;
+                }
+                else if (resp == Response::BACK) // Игрок вернул свой ход, пока бот думал
+                {
+                    board.rollback(); // Откатываем ход игрока
+                    turn_num -= 2; // Снова ход игрока
+                }
+            }
         }
         auto end = chrono::steady_clock::now(); // Запоминаем время окончания игры
-        ofstream fout(project_path + "log.txt", ios_base::app); // Открываем файл лога для записи
-        fout << "Game time: " << (int)chrono::duration<double, milli>(end - start).count() << " millisec\n"; // Записываем время игры в лог
-        fout.close(); // Закрываем файл лога
+        logger.info("game_time", {{"ms", (int)chrono::duration<double, milli>(end - start).count()},
+                                  {"turns", turn_num}}); // Записываем время игры в лог
 
         if (is_replay) // Если это повторная игра, запускаем игру снова
             return play();
@@ -104,16 +133,46 @@ class Game
     }
 
   private:
-    void bot_turn(const bool color)
+    // Запуск поиска на время игрока для бота цвета color в отдельном потоке
+    // Глубину ponder выбирает сам: углубляется с нуля, пока игрок не сделает ход
+    void start_ponder(const bool color)
+    {
+        ponder_stop = false;
+        ponderer = make_unique<Logic>(logic); // Копия логики с общей таблицей транспозиций
+        ponder_thread = thread(&Logic::ponder, ponderer.get(), board.get_board(), color, &ponder_stop);
+    }
+
+    // Остановка поиска на время игрока
+    void stop_ponder()
+    {
+        if (!ponder_thread.joinable())
+            return;
+        ponder_stop = true;
+        ponder_thread.join();
+        ponderer.reset();
+    }
+
+    // Ход бота: поиск идет в потоке searcher, а окно в это время откликается на события
+    // Возвращает OK или действие игрока, прервавшее ход (BACK - только если соперник бота человек)
+    Response bot_turn(const bool color)
     {
         auto start = chrono::steady_clock::now(); // Запоминаем время начала хода бота
 
-        auto delay_ms = config("Bot", "BotDelayMS"); // Получаем задержку перед ходом бота из конфигурации
-        // new thread for equal delay for each turn
-        // Создаем новый поток для равномерной задержки каждого хода
-        thread th(SDL_Delay, delay_ms);
-        auto turns = logic.find_best_turns(color); // Находим лучшие ходы для бота
-        th.join(); // Ожидаем завершения потока задержки
+        const int delay_ms = config("Bot", "BotDelayMS"); // Получаем задержку перед ходом бота из конфигурации
+        const bool vs_human = !config("Bot", string("Is") + string(color ? "White" : "Black") + string("Bot"));
+        // Поиск вместе с задержкой хода идет в потоке поиска, по готовности он будит окно
+        searcher.start(&logic, board.get_board(), color, delay_ms, Hand::wake);
+        while (true)
+        {
+            auto resp = hand.wait_for([&] { return searcher.ready(); });
+            if (resp == Response::OK)
+                break;
+            if (resp == Response::BACK && !vs_human) // Откатывать нечего: оба игрока боты
+                continue;
+            searcher.cancel(); // Останавливаем поиск сразу
+            return resp;
+        }
+        auto turns = searcher.result(); // Лучшие ходы бота
         bool is_first = true; // Флаг первого хода в серии взятий
         // making moves
         // Выполняем найденные ходы
@@ -121,17 +180,29 @@ class Game
         {
             if (!is_first) // Если это не первый ход, добавляем задержку
             {
-                SDL_Delay(delay_ms); 
+                const auto until = chrono::steady_clock::now() + chrono::milliseconds(delay_ms);
+                auto resp = Response::OK;
+                do // Посреди серии взятий откат не делаем
+                    resp = hand.wait_for([] { return false; }, until);
+                while (resp == Response::BACK);
+                if (resp != Response::OK)
+                    return resp;
             }
             is_first = false; // Сбрасываем флаг первого хода
             beat_series += (turn.xb != -1); // Увеличиваем серию взятий, если есть взятие
             board.move_piece(turn, beat_series); // Выполняем ход на доске
+            board.present(); // Показываем каждое взятие серии
         }
 
         auto end = chrono::steady_clock::now(); // Запоминаем время окончания хода бота
-        ofstream fout(project_path + "log.txt", ios_base::app); // Открываем файл лога для записи
-        fout << "Bot turn time: " << (int)chrono::duration<double, milli>(end - start).count() << " millisec\n"; // Записываем время хода бота в лог
-        fout.close(); // Закрываем файл лога
+        json record = {{"color", color ? "black" : "white"},
+                       {"move", turns_to_string(turns)},
+                       {"ms", (int)chrono::duration<double, milli>(end - start).count()}, // Время хода бота
+                       {"nodes", logic.nodes}};
+        if (SearchStats::enabled()) // Подробная статистика поиска
+            record["search"] = logic.stats.to_json();
+        logger.info("bot_turn", record);
+        return Response::OK;
     }
 
     Response player_turn(const bool color)
@@ -207,7 +278,7 @@ class Game
         beat_series = 1;
         while (true)
         {
-            logic.find_turns(pos.x2, pos.y2); // Находим доступные ходы для текущей позиции
+            logic.find_turns(pos.x2, pos.y2, board.get_board()); // Находим доступные ходы для текущей позиции
             if (!logic.have_beats) // Если нет доступных взятий, завершаем серию
                 break;
 
@@ -253,9 +324,14 @@ class Game
 
   private:
     Config config;
+    Logger logger; // Журнал событий (объявлен до доски, которая пишет в него ошибки)
     Board board;
     Hand hand;
     Logic logic;
+    unique_ptr<Logic> ponderer; // Копия логики для поиска на время игрока
+    thread ponder_thread; // Поток поиска на время игрока
+    atomic<bool> ponder_stop{false}; // Сигнал остановки поиска на время игрока
+    SearchWorker searcher; // Поток поиска хода бота (объявлен после логики и останавливается раньше нее)
     int beat_series;
     bool is_replay = false;
 };
@@ -1,4 +1,6 @@
 #pragma once
+#include <chrono>
+#include <functional>
 #include <tuple>
 
 #include "../Models/Move.h"
@@ -16,91 +18,108 @@ class Hand
     // Метод для получения выбранной ячейки на доске
     tuple<Response, POS_T, POS_T> get_cell() const
     {
-        SDL_Event windowEvent;  // Структура для хранения событий SDL
-        Response resp = Response::OK; // Переменная для хранения типа ответа
-        int x = -1, y = -1; // Координаты клика мыши
-        int xc = -1, yc = -1; // Вычисленные координаты клетки на доске
-        while (true) // Бесконечный цикл для ожидания события
-        {
-            if (SDL_PollEvent(&windowEvent)) // Проверяем наличие нового события
-            {
-                switch (windowEvent.type) // Обрабатываем тип события
-                {
-                case SDL_QUIT: // Если игрок закрыл окно
-                    resp = Response::QUIT; // Устанавливаем ответ QUIT
-                    break;
-                case SDL_MOUSEBUTTONDOWN:  // Если игрок нажал кнопку мыши
-                    x = windowEvent.motion.x; // Получаем координату X клика
-                    y = windowEvent.motion.y; // Получаем координату Y клика
-                    xc = int(y / (board->H / 10) - 1); // Вычисляем координату X клетки на доске
-                    yc = int(x / (board->W / 10) - 1); // Вычисляем координату Y клетки на доске
-                    // Обработка специальных клеток для отката хода и повторной игры
-                    if (xc == -1 && yc == -1 && board->history_mtx.size() > 1)
-                    {
-                        resp = Response::BACK; // Устанавливаем ответ BACK (откат хода)
-                    }
-                    else if (xc == -1 && yc == 8)
-                    {
-                        resp = Response::REPLAY; // Устанавливаем ответ REPLAY (повторная игра)
-                    }
-                    else if (xc >= 0 && xc < 8 && yc >= 0 && yc < 8)
-                    {
-                        resp = Response::CELL; // Устанавливаем ответ CELL (выбор клетки)
-                    }
-                    else
-                    {
-                        xc = -1; // Сбрасываем координаты, если они некорректны
-                        yc = -1;
-                    }
-                    break;
-                case SDL_WINDOWEVENT: // Обработка событий окна
-                    if (windowEvent.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) // Если размер окна изменился
-                    {
-                        board->reset_window_size(); // Сбрасываем размер окна
-                        break;
-                    }
-                }
-                if (resp != Response::OK) // Если ответ не равен OK, выходим из цикла
-                    break;
-            }
-        }
+        POS_T xc = -1, yc = -1; // Вычисленные координаты клетки на доске
+        const Response resp = wait_event(true, xc, yc); // Ждем значимого действия игрока
         return {resp, xc, yc}; // Возвращаем ответ и координаты клетки
     }
     // Метод для ожидания действия игрока (например, выбора повторной игры)
     Response wait() const
+    {
+        POS_T xc = -1, yc = -1;
+        return wait_event(false, xc, yc); // Во время игры выбор клеток не нужен
+    }
+
+    // Ожидание, пока done() не вернет true или не наступит deadline (например, пока ищет бот)
+    // Окно все это время откликается и перерисовывается, клики по клеткам не учитываются
+    // Возвращает OK или действие игрока (выход, повторная игра, откат хода), которое прервало ожидание
+    Response wait_for(const function<bool()> &done,
+                      const chrono::steady_clock::time_point deadline = chrono::steady_clock::time_point::max()) const
+    {
+        SDL_Event windowEvent;
+        while (!done())
+        {
+            board->present();
+            const auto now = chrono::steady_clock::now();
+            if (now >= deadline)
+                break;
+            // Спим до события, но не дольше, чем до deadline
+            const auto left = chrono::duration_cast<chrono::milliseconds>(deadline - now).count() + 1;
+            const int timeout = int(min<long long>(WAIT_TIMEOUT_MS, left));
+            if (!SDL_WaitEventTimeout(&windowEvent, timeout))
+                continue;
+            POS_T xc = -1, yc = -1;
+            const Response resp = dispatch(windowEvent, true, xc, yc);
+            if (resp != Response::OK && resp != Response::CELL)
+                return resp;
+        }
+        return Response::OK;
+    }
+
+    // Пробуждение потока окна, ожидающего в wait_for (можно вызывать из любого потока)
+    static void wake()
+    {
+        SDL_Event event{};
+        event.type = SDL_USEREVENT;
+        SDL_PushEvent(&event);
+    }
+
+  private:
+    // Наибольшее время сна в ожидании события: поток блокируется в SDL и не тратит процессор
+    static const int WAIT_TIMEOUT_MS = 100;
+
+    // Ожидание события, значимого для игры; in_game - идет ли партия (доступны клетки и откат хода)
+    Response wait_event(const bool in_game, POS_T &xc, POS_T &yc) const
     {
         SDL_Event windowEvent; // Структура для хранения событий SDL
-        Response resp = Response::OK; // Переменная для хранения типа ответа
-        while (true) // Бесконечный цикл для ожидания события
+        while (true)
         {
-            if (SDL_PollEvent(&windowEvent)) // Проверяем наличие нового события
+            board->present(); // Перед сном выводим накопившиеся изменения доски
+            if (!SDL_WaitEventTimeout(&windowEvent, WAIT_TIMEOUT_MS)) // Событий нет - снова засыпаем
+                continue;
+            const Response resp = dispatch(windowEvent, in_game, xc, yc); // Разбираем событие
+            if (resp != Response::OK) // Если ответ не равен OK, выходим из цикла
+                return resp;
+        }
+    }
+
+    // Единый разбор событий SDL: изменение окна обрабатывается на месте, остальное переводится в ответ игре
+    Response dispatch(const SDL_Event &windowEvent, const bool in_game, POS_T &xc, POS_T &yc) const
+    {
+        switch (windowEvent.type) // Обрабатываем тип события
+        {
+        case SDL_QUIT: // Если игрок закрыл окно
+            return Response::QUIT;
+        case SDL_WINDOWEVENT: // Обработка событий окна
+            if (windowEvent.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) // Если размер окна изменился
+                board->reset_window_size(); // Сбрасываем размер окна
+            else if (windowEvent.window.event == SDL_WINDOWEVENT_EXPOSED) // Если окно нужно перерисовать
+                board->invalidate();
+            return Response::OK;
+        case SDL_MOUSEBUTTONDOWN: // Если игрок нажал кнопку мыши
+        {
+            const int x = windowEvent.motion.x; // Получаем координату X клика
+            const int y = windowEvent.motion.y; // Получаем координату Y клика
+            const int cx = int(y / (board->H / 10) - 1); // Вычисляем координату X клетки на доске
+            const int cy = int(x / (board->W / 10) - 1); // Вычисляем координату Y клетки на доске
+            // Обработка специальных клеток для отката хода и повторной игры
+            if (cx == -1 && cy == 8)
+                return Response::REPLAY; // Повторная игра доступна всегда
+            if (!in_game)
+                return Response::OK;
+            if (cx == -1 && cy == -1 && board->journal.size() > 0)
+                return Response::BACK; // Откат хода
+            if (cx >= 0 && cx < 8 && cy >= 0 && cy < 8)
             {
-                switch (windowEvent.type) // Обрабатываем тип события
-                {
-                case SDL_QUIT: // Если игрок закрыл окно
-                    resp = Response::QUIT; // Устанавливаем ответ QUIT
-                    break;
-                case SDL_WINDOWEVENT_SIZE_CHANGED: // Если размер окна изменился
-                    board->reset_window_size(); // Сбрасываем размер окна
-                    break;
-                case SDL_MOUSEBUTTONDOWN: // Если игрок нажал кнопку мыши
-                { 
-                    int x = windowEvent.motion.x; // Получаем координату X клика
-                    int y = windowEvent.motion.y; // Получаем координату Y клика
-                    int xc = int(y / (board->H / 10) - 1); // Вычисляем координату X клетки на доске
-                    int yc = int(x / (board->W / 10) - 1); // Вычисляем координату Y клетки на доске
-                    if (xc == -1 && yc == 8) // Обработка специальной клетки для повторной игры
-                        resp = Response::REPLAY; // Устанавливаем ответ REPLAY
-                }
-                break;
-                }
-                if (resp != Response::OK) // Если ответ не равен OK, выходим из цикла
-                    break;
+                xc = POS_T(cx);
+                yc = POS_T(cy);
+                return Response::CELL; // Выбор клетки
             }
+            return Response::OK; // Клик мимо доски и кнопок
+        }
+        default:
+            return Response::OK; // Остальные события игре не нужны
         }
-        return resp; // Возвращаем ответ
     }
 
-  private:
     Board *board; // Указатель на объект доски
 };
@@ -0,0 +1,110 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+#include "../Models/Move.h"
+#include "../Models/Position.h"
+#include "MoveGen.h"
+
+using namespace std;
+
+// Запись журнала (4 байта): один ход или одно взятие серии и все, что нужно для его отката
+struct journal_entry
+{
+    int8_t from = 0;     // Клетка начала хода (номер бита)
+    int8_t to = 0;       // Клетка конца хода
+    int8_t beaten = -1;  // Клетка взятой фигуры или -1
+    uint8_t flags = 0;   // Биты: 0 - взята дамка, 1 - превращение в дамку, со 2-го - номер взятия в серии
+
+    move_pos turn() const
+    {
+        if (beaten == -1)
+            return move_pos(Position::square_x(from), Position::square_y(from), Position::square_x(to),
+                            Position::square_y(to));
+        return move_pos(Position::square_x(from), Position::square_y(from), Position::square_x(to),
+                        Position::square_y(to), Position::square_x(beaten), Position::square_y(beaten));
+    }
+
+    move_undo undo() const
+    {
+        move_undo res;
+        res.beaten_king = flags & 1;
+        res.promoted = (flags >> 1) & 1;
+        return res;
+    }
+
+    // Номер взятия в серии (0 - тихий ход)
+    int beat_series() const
+    {
+        return flags >> 2;
+    }
+};
+
+// Журнал партии: начальная позиция и обратимые ходы вместо копии доски после каждого хода
+// Откат последнего хода - O(1). Каждые CHECKPOINT ходов запоминается позиция, чтобы позицию
+// после любого хода можно было восстановить, проиграв не больше CHECKPOINT ходов
+class Journal
+{
+  public:
+    static const size_t CHECKPOINT = 64;
+
+    // Начало новой партии с позиции start
+    void reset(const Position &start)
+    {
+        entries.clear();
+        checkpoints.assign(1, start);
+    }
+
+    // Выполнение хода на позиции mtx с записью в журнал
+    void push(Position &mtx, const move_pos &turn, const int beat_series = 0)
+    {
+        const move_undo undo = MoveGen::make_turn(mtx, turn);
+        journal_entry entry;
+        entry.from = int8_t(Position::square(turn.x, turn.y));
+        entry.to = int8_t(Position::square(turn.x2, turn.y2));
+        entry.beaten = int8_t(turn.xb == -1 ? -1 : Position::square(turn.xb, turn.yb));
+        entry.flags = uint8_t((undo.beaten_king ? 1 : 0) | (undo.promoted ? 2 : 0) | (beat_series << 2));
+        entries.push_back(entry);
+        if (entries.size() % CHECKPOINT == 0)
+            checkpoints.push_back(mtx);
+    }
+
+    // Откат последнего хода на позиции mtx
+    void pop(Position &mtx)
+    {
+        if (entries.size() % CHECKPOINT == 0)
+            checkpoints.pop_back();
+        const journal_entry &entry = entries.back();
+        MoveGen::unmake_turn(mtx, entry.turn(), entry.undo());
+        entries.pop_back();
+    }
+
+    // Позиция после первых n ходов журнала
+    Position position_at(const size_t n) const
+    {
+        Position mtx = checkpoints[n / CHECKPOINT];
+        for (size_t i = n / CHECKPOINT * CHECKPOINT; i < n; ++i)
+            MoveGen::make_turn(mtx, entries[i].turn());
+        return mtx;
+    }
+
+    // Номер взятия в серии у последнего хода (0 - тихий ход или журнал пуст)
+    int last_beat_series() const
+    {
+        return entries.empty() ? 0 : entries.back().beat_series();
+    }
+
+    size_t size() const
+    {
+        return entries.size();
+    }
+
+    const vector<journal_entry> &turns() const
+    {
+        return entries;
+    }
+
+  private:
+    vector<journal_entry> entries;
+    vector<Position> checkpoints; // Позиции после 0, CHECKPOINT, 2 * CHECKPOINT, ... ходов
+};
@@ -0,0 +1,243 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "Config.h"
+
+using namespace std;
+
+// Уровень записи журнала
+enum class LogLevel : uint8_t
+{
+    Debug,
+    Info,
+    Warning,
+    Error
+};
+
+// Журнал событий в формате JSON Lines: одна строка - один объект {"ts", "level", "event", "data"}
+// Потоки игры кладут записи в кольцевой буфер без блокировок и без обращения к диску, а пишет в файл
+// отдельный поток. Если буфер заполнен, запись отбрасывается (число потерь попадает в журнал), так что
+// запись в журнал никогда не задерживает ход. Когда файл вырастает больше max_bytes, он переименовывается
+// в name.1 (старые копии сдвигаются до name.<files - 1>) и начинается новый
+class Logger
+{
+  public:
+    Logger(const string &path, const size_t max_bytes, const int files)
+        : path(path), max_bytes(max_bytes), files(max(files, 1)), slots(new log_slot[CAPACITY])
+    {
+        for (size_t i = 0; i < CAPACITY; ++i)
+            slots[i].seq.store(i, memory_order_relaxed);
+        rotate(); // Журнал прошлого запуска сохраняется в name.1
+        open();
+        writer = thread(&Logger::run, this);
+    }
+    Logger(const Logger &) = delete;
+    Logger &operator=(const Logger &) = delete;
+    ~Logger()
+    {
+        {
+            lock_guard<mutex> lock(m);
+            stopping = true;
+        }
+        cv.notify_all();
+        writer.join();
+    }
+
+    // Запись события event с данными data (объект JSON); можно вызывать из любого потока
+    void log(const LogLevel level, const char *event, const json &data = json::object())
+    {
+        push(level, event, data.dump());
+    }
+
+    void info(const char *event, const json &data = json::object())
+    {
+        log(LogLevel::Info, event, data);
+    }
+
+    void error(const char *event, const json &data = json::object())
+    {
+        log(LogLevel::Error, event, data);
+    }
+
+    // Ожидание, пока все уже добавленные записи попадут в файл
+    void flush()
+    {
+        unique_lock<mutex> lock(m);
+        const size_t target = tail.load(memory_order_acquire);
+        flush_requested = true;
+        cv.notify_all();
+        cv.wait(lock, [&] { return written >= target; });
+    }
+
+  private:
+    static const size_t CAPACITY = 512;  // Число записей в буфере (степень двойки)
+    static const size_t DATA_SIZE = 1000; // Наибольшая длина данных записи в байтах
+    static const size_t EVENT_SIZE = 24;
+
+    struct log_slot
+    {
+        atomic<size_t> seq{0}; // Номер записи, которую ждет ячейка (очередь Вьюкова)
+        int64_t time_us = 0;   // Время записи (микросекунды с 1970 года)
+        LogLevel level = LogLevel::Info;
+        char event[EVENT_SIZE];
+        char data[DATA_SIZE];
+    };
+
+    // Добавление записи в буфер без блокировок, при заполненном буфере запись отбрасывается
+    void push(const LogLevel level, const char *event, const string &data)
+    {
+        size_t pos = tail.load(memory_order_relaxed);
+        log_slot *slot;
+        while (true)
+        {
+            slot = &slots[pos & (CAPACITY - 1)];
+            const size_t seq = slot->seq.load(memory_order_acquire);
+            if (seq == pos)
+            {
+                if (tail.compare_exchange_weak(pos, pos + 1, memory_order_relaxed))
+                    break;
+            }
+            else if (seq < pos) // Ячейку еще не прочитал писатель: буфер заполнен
+            {
+                dropped.fetch_add(1, memory_order_relaxed);
+                return;
+            }
+            else
+                pos = tail.load(memory_order_relaxed);
+        }
+        slot->time_us = now_us();
+        slot->level = level;
+        strncpy(slot->event, event, EVENT_SIZE - 1);
+        slot->event[EVENT_SIZE - 1] = 0;
+        if (data.size() < DATA_SIZE)
+            memcpy(slot->data, data.c_str(), data.size() + 1);
+        else // Слишком длинные данные не обрезаются (получился бы неверный JSON), а заменяются их длиной
+            snprintf(slot->data, DATA_SIZE, "{\"truncated_bytes\":%zu}", data.size());
+        slot->seq.store(pos + 1, memory_order_release);
+        if ((pos & (CAPACITY / 4 - 1)) == 0) // Буфер заполняется быстро: будим поток записи, не дожидаясь таймера
+            cv.notify_one();
+    }
+
+    // Поток записи: забирает записи из буфера, пишет их в файл и при необходимости начинает новый файл
+    void run()
+    {
+        string line;
+        while (true)
+        {
+            size_t count = 0;
+            while (true)
+            {
+                log_slot &slot = slots[head & (CAPACITY - 1)];
+                if (slot.seq.load(memory_order_acquire) != head + 1) // Записей больше нет (или она еще пишется)
+                    break;
+                format(slot, line);
+                slot.seq.store(head + CAPACITY, memory_order_release); // Ячейка снова свободна
+                ++head;
+                ++count;
+                fout << line;
+                size += line.size();
+                if (size >= max_bytes)
+                {
+                    fout.close();
+                    rotate();
+                    open();
+                }
+            }
+            const uint64_t lost = dropped.exchange(0, memory_order_relaxed);
+            if (lost) // Запись о потерянных записях собирается так же, как обычная
+            {
+                log_slot note;
+                note.time_us = now_us();
+                note.level = LogLevel::Warning;
+                snprintf(note.event, EVENT_SIZE, "log_overflow");
+                snprintf(note.data, DATA_SIZE, "{\"dropped\":%llu}", (unsigned long long)lost);
+                format(note, line);
+                fout << line;
+                size += line.size();
+            }
+            if (count || lost)
+                fout.flush();
+
+            unique_lock<mutex> lock(m);
+            written = head;
+            cv.notify_all();
+            if (stopping && tail.load(memory_order_acquire) == head)
+                return;
+            if (!flush_requested)
+                cv.wait_for(lock, chrono::milliseconds(50), [&] {
+                    return stopping || flush_requested || tail.load(memory_order_relaxed) - head >= CAPACITY / 4;
+                });
+            flush_requested = false;
+        }
+    }
+
+    static int64_t now_us()
+    {
+        return chrono::duration_cast<chrono::microseconds>(chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    // Строка JSON для записи
+    static void format(const log_slot &slot, string &line)
+    {
+        static const char *LEVELS[] = {"debug", "info", "warning", "error"};
+        const time_t sec = time_t(slot.time_us / 1000000);
+        tm utc{};
+#ifdef _WIN32
+        gmtime_s(&utc, &sec);
+#else
+        gmtime_r(&sec, &utc);
+#endif
+        char ts[40];
+        snprintf(ts, sizeof(ts), "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ", utc.tm_year + 1900, utc.tm_mon + 1,
+                 utc.tm_mday, utc.tm_hour, utc.tm_min, utc.tm_sec, int(slot.time_us / 1000 % 1000));
+        line = string("{\"ts\":\"") + ts + "\",\"level\":\"" + LEVELS[int(slot.level)] + "\",\"event\":\"" +
+               slot.event + "\",\"data\":" + slot.data + "}\n";
+    }
+
+    // Сдвиг старых файлов: name.<files - 2> -> name.<files - 1>, ..., name -> name.1
+    void rotate()
+    {
+        if (files == 1)
+        {
+            remove(path.c_str());
+            return;
+        }
+        remove((path + "." + to_string(files - 1)).c_str());
+        for (int i = files - 2; i >= 1; --i)
+            rename((path + "." + to_string(i)).c_str(), (path + "." + to_string(i + 1)).c_str());
+        rename(path.c_str(), (path + ".1").c_str());
+    }
+
+    void open()
+    {
+        fout.open(path, ios_base::trunc);
+        size = 0;
+    }
+
+    const string path;
+    const size_t max_bytes;
+    const int files;
+    unique_ptr<log_slot[]> slots;
+    atomic<size_t> tail{0};      // Номер следующей записи для производителей
+    size_t head = 0;             // Номер следующей записи для потока записи
+    atomic<uint64_t> dropped{0}; // Отброшенные при заполненном буфере записи
+    ofstream fout;
+    size_t size = 0; // Размер текущего файла
+    mutex m;
+    condition_variable cv;
+    size_t written = 0; // Записи, уже записанные в файл
+    bool stopping = false;
+    bool flush_requested = false;
+    thread writer;
+};
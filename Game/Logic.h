@@ -1,87 +1,532 @@
 #pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <deque>
+#include <memory>
 #include <random>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include "../Models/Move.h"
-#include "Board.h"
+#include "../Models/Position.h"
+#include "Book.h"
 #include "Config.h"
+#include "MoveGen.h"
+#include "SearchStats.h"
+#include "TTable.h"
+#include "Tablebase.h"
+
+using namespace std;
+
+// Логика бота не зависит от SDL2: позиция передается явно, поэтому ее можно использовать без окна (см. cli.cpp)
 
 const int INF = 1e9;
+// Оценки поиска - целые числа с фиксированной точкой: SCORE_ONE соответствует отношению сил 1.0 (равенство)
+// 2^21 больше произведения любых двух знаменателей оценки, поэтому разные отношения дают разные целые
+const int SCORE_ONE = 1 << 21;
+const int WIN_SCORE = INF / 2; // Оценки не меньше этой - выигрыш (по правилам или по эндшпильным таблицам)
+// Конец партии через n полуходов от корня оценивается INF - n (выигрыш бота) или n (проигрыш бота), n < MATE_PLIES
+// Оценка живой позиции не меньше SCORE_ONE / 60 (простая против 12 дамок), поэтому с оценками проигрыша не пересекается
+const int MATE_PLIES = 4096;
+const int ASPIRATION_WINDOW = SCORE_ONE / 32; // Начальная полуширина окна вокруг оценки прошлой итерации
+const int MAX_SEARCH_DEPTH = 64; // Предельная глубина итеративного углубления в режиме с ограничением времени
+const int TB_MAX_PIECES = 8; // Наибольшее число фигур, для которого ищутся файлы эндшпильных таблиц
+// Расстояния в таблицах не больше TB_MAX_DISTANCE полуходов, позиции с более долгим концом таблицы не решают
+// O2: наименьшая оставшаяся глубина для сокращения поздних ходов и для ProbCut, сокращение глубины пробы ProbCut
+const int LMR_MIN_DEPTH = 3, PROBCUT_MIN_DEPTH = 4, PROBCUT_REDUCTION = 3;
+// Приоритеты категорий при упорядочивании ходов
+const int ORDER_HASH = 1 << 30, ORDER_CAPTURE = 1 << 20, ORDER_KILLER = 1 << 19, ORDER_PROMOTION = 1 << 17;
+
+// Режим оценки позиции (Bot/BotScoringType)
+enum class Scoring
+{
+    NumberOnly,
+    NumberAndPotential
+};
+
+// Уровень оптимизации поиска (Bot/Optimization)
+enum class Optimization
+{
+    O0, // Полный перебор
+    O1, // Альфа-бета отсечения
+    O2  // Альфа-бета с выборочным поиском: сокращение поздних ходов и ProbCut
+};
+
+// Параметры поиска, известные на этапе компиляции: для каждого сочетания режима оценки, уровня оптимизации
+// и цвета бота строится своя версия поиска и оценки, и в горячем цикле нет проверок настроек
+template <Scoring S, Optimization O, bool BlackBot> struct SearchKernel
+{
+    static constexpr bool potential = S == Scoring::NumberAndPotential; // Учитывать потенциал фигур
+    static constexpr bool pruning = O != Optimization::O0;              // Использовать отсечения
+    static constexpr bool selective = O == Optimization::O2;            // Сокращать и отсекать по прогнозу
+    static constexpr bool black_bot = BlackBot; // Оценки считаются с точки зрения черного бота
+};
 
 class Logic
 {
 public:
-    Logic(Board *board, Config *config) : board(board), config(config)
+    Logic(Config *config) : config(config)
     {
+        no_random = (*config)("Bot", "NoRandom");
         rand_eng = std::default_random_engine (
-            !((*config)("Bot", "NoRandom")) ? unsigned(time(0)) : 0);
-        scoring_mode = (*config)("Bot", "BotScoringType");
-        optimization = (*config)("Bot", "Optimization");
+            !no_random ? unsigned(time(0)) : 0);
+        // Строковые настройки разбираются один раз, дальше поиск вызывается через выбранную специализацию
+        scoring = (*config)("Bot", "BotScoringType") == "NumberAndPotential" ? Scoring::NumberAndPotential
+                                                                              : Scoring::NumberOnly;
+        const string opt = (*config)("Bot", "Optimization");
+        optimization = opt == "O0" ? Optimization::O0 : (opt == "O2" ? Optimization::O2 : Optimization::O1);
+        lmr_moves = (*config)("Bot", "LMRMoves");
+        const double margin = (*config)("Bot", "ProbCutMargin");
+        probcut_scale = int((1 + max(margin, 0.0)) * SCORE_ONE);
+        select_kernels();
+        tt = make_shared<TTable>((*config)("Bot", "TTSizeMB")); // Выделяем таблицу транспозиций заданного размера
+        time_ms = (*config)("Bot", "BotTimeMS");
+        threads = (*config)("Bot", "BotThreads");
+        if (threads <= 0) // 0 - все доступные ядра
+            threads = max(1, int(thread::hardware_concurrency()));
+        const string tb_path = (*config)("Bot", "TablebasePath");
+        if (!tb_path.empty()) // Отображаем в память эндшпильные таблицы, если они построены (cli tbgen)
+        {
+            auto tables = make_shared<const Tablebase>(tb_path, TB_MAX_PIECES);
+            if (tables->max_pieces())
+                tb = tables;
+        }
+        const string book_path = (*config)("Bot", "BookPath");
+        if (!book_path.empty()) // Отображаем в память дебютную книгу, если она построена (cli book)
+        {
+            auto opening = make_shared<const Book>(book_path);
+            if (!opening->empty())
+                book = opening;
+        }
     }
     // Функция для нахождения лучших ходов для заданного цвета (игрока)
-    vector<move_pos> find_best_turns(const bool color)
+    // Если задан BotTimeMS, глубина увеличивается на 1, пока не кончится время, и берется результат последней завершенной глубины
+    // При BotThreads > 1 вспомогательные потоки ищут ту же позицию и делятся результатами через общую таблицу транспозиций
+    // Сигнал cancel прерывает поиск из другого потока, тогда результат пустой
+    vector<move_pos> find_best_turns(Position mtx, const bool color, const atomic<bool>* cancel = nullptr)
     {
-        // Очищаем векторы для хранения состояний и ходов
-        next_best_state.clear();
-        next_move.clear();
+        stop_signal = cancel;
+        find_root_turns(mtx, color); // Ходы корня (перемешанные, если бот не детерминированный)
+        nodes = 0;
+        stats.reset();
+        vector<move_pos> book_res;
+        if (book && book_turns(mtx, color, book_res)) // Ход из дебютной книги без поиска
+        {
+            last_score = 1; // Оценка книжного хода неизвестна, считаем силы равными
+            return book_res;
+        }
+        // Поиск изменяет одну позицию на месте и откатывает каждый ход на обратном пути
+        hash_key = zobrist_hash(mtx); // Полный ключ позиции считаем один раз, дальше он обновляется в do_turn
+        tt->new_search();
+        new_search_order(); // Сбрасываем киллеры и ослабляем историю прошлого хода
 
-        // Вызываем вспомогательную функцию для поиска первого лучшего хода
-        find_first_best_turn(board->get_board(), color, -1, -1, 0);
+        // Вспомогательные потоки работают с копиями логики, у каждой свой порядок ходов
+        atomic<bool> helpers_stop(false);
+        vector<Logic> helpers;
+        vector<thread> pool;
+        if (tt->enabled()) // Без общей таблицы помощники бесполезны
+        {
+            for (int i = 1; i < threads; ++i)
+            {
+                helpers.push_back(*this);
+                helpers.back().stop_signal = &helpers_stop;
+                helpers.back().rand_eng.seed(unsigned(rand_eng()) + i);
+            }
+            for (size_t i = 0; i < helpers.size(); ++i)
+                pool.emplace_back(&Logic::help_search, &helpers[i], mtx, color, int(i));
+        }
 
-        // Инициализируем текущее состояние
-        int cur_state = 0;
+        vector<move_pos> res = search_best_turns(mtx, color);
 
-        // Создаем вектор для хранения результата (лучших ходов)
-        vector<move_pos> res;
+        helpers_stop = true; // Останавливаем помощников, как только основной поиск завершен
+        for (auto& th : pool)
+            th.join();
+        return res;
+    }
+
+    // Поиск на время соперника: бот цвета color ждет ответа противника на позиции mtx
+    // Позиции после всех ответов противника ищутся с углублением до сигнала stop, результаты остаются
+    // в общей таблице транспозиций, и после настоящего ответа поиск бота находит их готовыми
+    // Первым на каждой глубине проверяется ответ, который поиск бота считал лучшим для противника
+    void ponder(Position mtx, const bool color, const atomic<bool>* stop)
+    {
+        if (!tt->enabled())
+            return;
+        stop_signal = stop;
+        time_ms = 0;
+        // Свое поколение таблицы: записи ponder не вытесняются записями прошлого хода бота и мелкие
+        // не затирают глубокие. Следующий поиск бота начнет новое поколение, и записи ponder станут
+        // кандидатами на замену - так задумано: пока их не заменили, поиск бота их находит,
+        // а место в таблице в первую очередь получают его собственные результаты
+        tt->new_search();
+        vector<full_move> turns; // Полные ходы противника, серии с одним итогом уже объединены
+        MoveGen::generate_full(mtx, !color, turns);
+        tt_entry entry; // Ожидаемый ответ - лучший ход противника из таблицы
+        const uint64_t key = zobrist_hash(mtx) ^ (!color ? ZOBRIST.side : 0) ^ (color ? ZOBRIST.perspective : 0);
+        if (tt->probe(key, entry) && entry.from != -1)
+        {
+            auto it = find_if(turns.begin(), turns.end(),
+                              [&](const full_move& turn) { return turn.from == entry.from && turn.to == entry.to; });
+            if (it != turns.end())
+                rotate(turns.begin(), it, it + 1);
+        }
+        vector<Position> replies; // Позиции после ответов
+        for (const auto& turn : turns)
+        {
+            replies.push_back(mtx);
+            MoveGen::make_full(replies.back(), turn);
+        }
+        for (Max_depth = 0; Max_depth < MAX_SEARCH_DEPTH && !*stop; ++Max_depth)
+        {
+            for (auto& reply : replies)
+            {
+                if (*stop)
+                    break;
+                find_root_turns(reply, color);
+                if (root_turns.empty())
+                    continue;
+                hash_key = zobrist_hash(reply);
+                search_root(reply, color);
+            }
+        }
+    }
 
-        // Цикл для сбора всех найденных ходов
-        do
+private:
+    // Выбор хода из дебютной книги: случайно пропорционально весу, а при NoRandom - ход с наибольшим весом
+    bool book_turns(const Position& mtx, const bool color, vector<move_pos>& res)
+    {
+        const auto range = book->probe(book_key(mtx, color));
+        if (range.first == range.second)
+            return false;
+        vector<full_move> full; // Каждая позиция после хода встречается один раз, сколько бы серий к ней ни вело
+        MoveGen::generate_full(mtx, color, full);
+        vector<pair<const full_move*, uint64_t>> candidates; // Ход и вес книжного хода
+        uint64_t total = 0;
+        for (const auto& turn : full)
+        {
+            Position after = mtx;
+            MoveGen::make_full(after, turn);
+            const uint64_t next = book_key(after, !color);
+            for (auto e = range.first; e != range.second; ++e)
+            {
+                if (e->next != next)
+                    continue;
+                candidates.emplace_back(&turn, e->weight);
+                total += e->weight;
+            }
+        }
+        if (candidates.empty()) // Ключ совпал случайно, ходов книги в позиции нет
+            return false;
+        size_t pick = 0;
+        if (no_random)
+        {
+            for (size_t i = 1; i < candidates.size(); ++i)
+                if (candidates[i].second > candidates[pick].second)
+                    pick = i;
+        }
+        else
         {
-            // Добавляем текущий ход в результат
-            res.push_back(next_move[cur_state]);
+            uint64_t r = uniform_int_distribution<uint64_t>(0, total - 1)(rand_eng);
+            while (r >= candidates[pick].second)
+                r -= candidates[pick++].second;
+        }
+        res = MoveGen::series_of(mtx, color, *candidates[pick].first);
+        return true;
+    }
 
-            // Переходим к следующему состоянию
-            cur_state = next_best_state[cur_state];
-        } while (cur_state != -1 && next_move[cur_state].x != -1); // Продолжаем цикл, пока есть следующие состояния и ходы
+    // Основной поиск: на фиксированную глубину или итеративным углублением по времени
+    vector<move_pos> search_best_turns(Position& mtx, const bool color)
+    {
+        if (time_ms <= 0) // Поиск на фиксированную глубину уровня бота
+        {
+            const int score = search_root(mtx, color);
+            if (stop_search) // Поиск отменен, дерево просмотрено не полностью
+                return {};
+            last_score = score_to_ratio(score);
+            stats.iteration(Max_depth, last_score);
+            return collect_best_turns(mtx, color);
+        }
 
-        // Возвращаем вектор с лучшими ходами
+        const int level = Max_depth; // Сохраняем глубину уровня бота
+        deadline = chrono::steady_clock::now() + chrono::milliseconds(time_ms);
+        vector<move_pos> res;
+        int score = 0;
+        for (Max_depth = 0; Max_depth < MAX_SEARCH_DEPTH; ++Max_depth)
+        {
+            horizon_reached = false;
+            score = Max_depth == 0 ? search_root(mtx, color) : aspiration_search(mtx, color, score);
+            if (stop_search) // Незавершенная итерация отбрасывается
+                break;
+            last_score = score_to_ratio(score);
+            stats.iteration(Max_depth, last_score);
+            res = collect_best_turns(mtx, color);
+            if (!horizon_reached) // Дерево просмотрено до конца партии, углубляться некуда
+                break;
+            // Лучший ход завершенной итерации проверяем первым на следующей
+            auto it = find(root_turns.begin(), root_turns.end(), best_root_turn);
+            if (it != root_turns.end())
+                rotate(root_turns.begin(), it, it + 1);
+        }
+        Max_depth = level;
         return res;
     }
 
+    // Поиск во вспомогательном потоке: углубление до сигнала остановки, результаты попадают только в таблицу
+    // Половина помощников начинает на одну глубину дальше основного потока
+    void help_search(Position mtx, const bool color, const int index)
+    {
+        time_ms = 0;
+        shuffle(root_turns.begin(), root_turns.end(), rand_eng);
+        for (Max_depth += index % 2; Max_depth < MAX_SEARCH_DEPTH && !*stop_signal; ++Max_depth)
+            search_root(mtx, color);
+    }
+
+    // Поиск итерации с окном вокруг оценки прошлой итерации: узкое окно дает больше отсечений
+    // Если оценка вышла за окно, окно расширяется в ту сторону, пока оценка не окажется внутри
+    int aspiration_search(Position& mtx, const bool color, const int previous)
+    {
+        if (optimization == Optimization::O0 || previous >= WIN_SCORE) // Без отсечений окно ничего не дает
+            return search_root(mtx, color);
+        int delta = ASPIRATION_WINDOW;
+        int alpha = previous - delta, beta = previous + delta;
+        while (true)
+        {
+            const int score = search_root(mtx, color, alpha, beta);
+            if (stop_search || (score > alpha && score < beta) || (alpha == -INF - 1 && beta == INF + 1))
+                return score;
+            delta = delta >= WIN_SCORE / 4 ? WIN_SCORE : delta * 4;
+            if (score <= alpha)
+                alpha = delta >= WIN_SCORE ? -INF - 1 : previous - delta;
+            else
+                beta = delta >= WIN_SCORE ? INF + 1 : previous + delta;
+        }
+    }
+
+private:
+    // Запуск поиска из корня для текущего Max_depth с окном (alpha, beta), возвращает оценку лучшего хода
+    int search_root(Position& mtx, const bool color, const int alpha = -INF - 1, const int beta = INF + 1)
+    {
+        ply = 0;
+        stop_search = false;
+        // Вызываем специализацию поиска первого лучшего хода для цвета бота
+        return (this->*root_search[color])(mtx, color, alpha, beta);
+    }
+
+    // Оценка поиска в единицах отношения сил (1 - равенство) для вывода; выигрыш остается около INF, проигрыш - 0
+    static double score_to_ratio(const int score)
+    {
+        if (score < MATE_PLIES)
+            return 0;
+        return score >= WIN_SCORE ? double(score) : double(score) / SCORE_ONE;
+    }
+
+    using RootSearch = int (Logic::*)(Position&, const bool, const int, const int);
+
+    // Выбор специализаций поиска для обоих цветов бота по настройкам
+    void select_kernels()
+    {
+        root_search[0] = select_kernel<false>();
+        root_search[1] = select_kernel<true>();
+    }
+
+    template <bool BlackBot> RootSearch select_kernel() const
+    {
+        if (scoring == Scoring::NumberAndPotential)
+            return select_kernel<Scoring::NumberAndPotential, BlackBot>();
+        return select_kernel<Scoring::NumberOnly, BlackBot>();
+    }
+
+    template <Scoring S, bool BlackBot> RootSearch select_kernel() const
+    {
+        if (optimization == Optimization::O0)
+            return &Logic::find_first_best_turn<SearchKernel<S, Optimization::O0, BlackBot>>;
+        if (optimization == Optimization::O2)
+            return &Logic::find_first_best_turn<SearchKernel<S, Optimization::O2, BlackBot>>;
+        return &Logic::find_first_best_turn<SearchKernel<S, Optimization::O1, BlackBot>>;
+    }
+
+    // Лучший ход корня в виде серии ходов для доски: серия, которая приводит к той же позиции, что и полный ход
+    vector<move_pos> collect_best_turns(const Position& mtx, const bool color) const
+    {
+        return MoveGen::series_of(mtx, color, best_root_turn);
+    }
+
+    // Подсчет узла и проверка сигнала остановки и лимита времени раз в 1024 узла,
+    // глубина 0 основного поиска всегда досчитывается до конца
+    bool time_is_up()
+    {
+        if (stop_search)
+            return true;
+        if (stop_signal && stop_signal->load(memory_order_relaxed)) // Сигнал остановки или отмены поиска
+            return stop_search = true;
+        if ((++nodes & 1023) || time_ms <= 0 || Max_depth == 0)
+            return false;
+        stop_search = chrono::steady_clock::now() >= deadline;
+        return stop_search;
+    }
+
 private:
-    // Функция для выполнения хода на доске
-    vector<vector<POS_T>> make_turn(vector<vector<POS_T>> mtx, move_pos turn) const
+    // Функция для выполнения полного хода на позиции на месте, возвращает взятые дамки для его отката
+    // Ключ Зобриста позиции обновляется инкрементально
+    uint32_t do_turn(Position& mtx, const full_move& turn)
+    {
+        const bool color = (mtx.black >> turn.from) & 1; // Цвет ходящей фигуры
+        const bool is_king = (mtx.kings >> turn.from) & 1;
+        hash_key ^= ZOBRIST.piece[color + (is_king ? 2 : 0)][turn.from] ^
+                    ZOBRIST.piece[color + (is_king || turn.promotes ? 2 : 0)][turn.to];
+        for (uint32_t b = turn.captured; b; b &= b - 1) // Убираем из ключа взятые фигуры
+        {
+            const int sq = lsb_index(b);
+            hash_key ^= ZOBRIST.piece[!color + ((mtx.kings >> sq) & 1) * 2][sq];
+        }
+        return MoveGen::make_full(mtx, turn);
+    }
+
+    // Функция для отката хода, выполненного do_turn
+    void undo_turn(Position& mtx, const full_move& turn, const uint32_t beaten_kings)
+    {
+        MoveGen::unmake_full(mtx, turn, beaten_kings);
+        const bool color = (mtx.black >> turn.from) & 1; // Цвет ходившей фигуры
+        const bool is_king = (mtx.kings >> turn.from) & 1; // Фигура была дамкой до хода
+        hash_key ^= ZOBRIST.piece[color + (is_king ? 2 : 0)][turn.from] ^
+                    ZOBRIST.piece[color + (is_king || turn.promotes ? 2 : 0)][turn.to];
+        for (uint32_t b = turn.captured; b; b &= b - 1)
+        {
+            const int sq = lsb_index(b);
+            hash_key ^= ZOBRIST.piece[!color + ((beaten_kings >> sq) & 1) * 2][sq];
+        }
+    }
+
+    // Ключ узла поиска: позиция, очередь хода и цвет бота, с точки зрения которого считаются оценки
+    template <class K> uint64_t node_key(const bool color) const
+    {
+        return hash_key ^ (color ? ZOBRIST.side : 0) ^ (K::black_bot ? ZOBRIST.perspective : 0);
+    }
+
+    // Буфер ходов для текущего уровня рекурсии, чтобы не копировать ходы в каждом узле
+    vector<full_move>& ply_buffer()
+    {
+        while (ply_turns.size() <= ply)
+        {
+            ply_turns.emplace_back();
+            ply_order.emplace_back();
+            killers.push_back({-1, -1});
+        }
+        return ply_turns[ply];
+    }
+
+    // Генерация ходов для цвета (x == -1) или для одной фигуры в заданный буфер, возвращает флаг наличия взятий
+    bool gen_turns(const Position& mtx, const bool color, const POS_T x, const POS_T y, vector<move_pos>& res)
+    {
+        const uint32_t from = (x != -1 ? uint32_t(1) << Position::square(x, y) : ~uint32_t(0));
+        return MoveGen::generate(mtx, color, from, res);
+    }
+
+    // Ходы корня для поиска: полные ходы, перемешанные, если бот не детерминированный
+    // Случайность только в корне: из равных по оценке ходов выберется случайный
+    void find_root_turns(const Position& mtx, const bool color)
+    {
+        MoveGen::generate_full(mtx, color, root_turns);
+        if (!no_random)
+            shuffle(root_turns.begin(), root_turns.end(), rand_eng);
+    }
+
+    // Оценка ходов узла для упорядочивания: ход из таблицы, взятия (больше взятых фигур и дамок, превращения выше),
+    // киллеры, история
+    void order_turns(const Position& mtx, const bool color, const vector<full_move>& turns_now, const int hash_from,
+                     const int hash_to)
+    {
+        vector<int>& order = ply_order[ply];
+        order.resize(turns_now.size());
+        for (size_t i = 0; i < turns_now.size(); ++i)
+        {
+            const full_move& turn = turns_now[i];
+            const int from = turn.from, to = turn.to;
+            int score;
+            if (from == hash_from && to == hash_to)
+                score = ORDER_HASH;
+            else if (turn.captured)
+                score = ORDER_CAPTURE + popcount32(turn.captured) * 4 + popcount32(turn.captured & mtx.kings) * 2 +
+                        turn.promotes;
+            else if (from * 32 + to == killers[ply][0])
+                score = ORDER_KILLER + 1;
+            else if (from * 32 + to == killers[ply][1])
+                score = ORDER_KILLER;
+            else
+                score = history[color][from][to] + turn.promotes * ORDER_PROMOTION;
+            order[i] = score;
+        }
+    }
+
+    // Перенос лучшего из оставшихся ходов на позицию i (выборочная сортировка: при отсечении остаток не сортируется)
+    void pick_turn(vector<full_move>& turns_now, const size_t i)
+    {
+        vector<int>& order = ply_order[ply];
+        size_t best = i;
+        for (size_t j = i + 1; j < turns_now.size(); ++j)
+        {
+            if (order[j] > order[best])
+                best = j;
+        }
+        swap(turns_now[i], turns_now[best]);
+        swap(order[i], order[best]);
+    }
+
+    // Запоминание тихого хода, вызвавшего отсечение: киллер текущего уровня и счетчик истории
+    void update_cutoff_stats(const bool color, const full_move& turn, const int depth_left)
+    {
+        const int from = turn.from, to = turn.to;
+        if (killers[ply][0] != from * 32 + to)
+        {
+            killers[ply][1] = killers[ply][0];
+            killers[ply][0] = from * 32 + to;
+        }
+        history[color][from][to] += depth_left * depth_left;
+        if (history[color][from][to] >= ORDER_PROMOTION) // Не даем истории догнать более важные категории
+            age_history();
+    }
+
+    // Ослабление истории вдвое
+    void age_history()
+    {
+        for (auto& side : history)
+            for (auto& row : side)
+                for (int& h : row)
+                    h /= 2;
+    }
+
+    // Подготовка эвристик упорядочивания к новому поиску
+    void new_search_order()
     {
-        if (turn.xb != -1) // Если есть взятие
-            mtx[turn.xb][turn.yb] = 0; // Удаляем взятую фигуру
-        if ((mtx[turn.x][turn.y] == 1 && turn.x2 == 0) || (mtx[turn.x][turn.y] == 2 && turn.x2 == 7)) // Преобразование в дамку при достижении противоположного края доски
-            mtx[turn.x][turn.y] += 2;
-        mtx[turn.x2][turn.y2] = mtx[turn.x][turn.y]; // Перемещаем фигуру на новую позицию
-        mtx[turn.x][turn.y] = 0; // Удаляем фигуру с начальной позиции
-        return mtx; // Возвращаем обновленную матрицу доски
+        for (auto& k : killers)
+            k = {-1, -1};
+        age_history();
     }
 
-    // Функция для вычисления оценки текущего состояния доски
-    double calc_score(const vector<vector<POS_T>>& mtx, const bool first_bot_color) const
+    // Функция для вычисления оценки текущего состояния доски с точки зрения бота K::black_bot
+    // Отношение сил бота и противника в единицах SCORE_ONE; веса фигур считаются в двадцатых долях простой,
+    // чтобы потенциал 0.05 за ряд был целым и в оценке не было чисел с плавающей точкой
+    template <class K> int calc_score(const Position& mtx) const
     {
-        // color - кто является максимизирующим игроком
-        double w = 0, wq = 0, b = 0, bq = 0; // Счетчики для белых и черных фигур и дамок
-        for (POS_T i = 0; i < 8; ++i) // Проходим по всем клеткам доски
+        const uint32_t w_men = mtx.white & ~mtx.kings, b_men = mtx.black & ~mtx.kings; // Маски простых фигур
+        int w = 20 * popcount32(w_men); // Подсчет белых фигур
+        int wq = popcount32(mtx.white & mtx.kings); // Подсчет белых дамок
+        int b = 20 * popcount32(b_men); // Подсчет черных фигур
+        int bq = popcount32(mtx.black & mtx.kings); // Подсчет черных дамок
+        if constexpr (K::potential) // Если используется режим оценки "NumberAndPotential"
         {
-            for (POS_T j = 0; j < 8; ++j)
+            for (POS_T i = 0; i < 8; ++i) // Проходим по строкам доски, в каждой строке 4 игровые клетки
             {
-                w += (mtx[i][j] == 1); // Подсчет белых фигур
-                wq += (mtx[i][j] == 3); // Подсчет белых дамок
-                b += (mtx[i][j] == 2); // Подсчет черных фигур
-                bq += (mtx[i][j] == 4); // Подсчет черных дамок
-                if (scoring_mode == "NumberAndPotential") // Если используется режим оценки "NumberAndPotential"
-                {
-                    w += 0.05 * (mtx[i][j] == 1) * (7 - i); // Добавляем потенциал для белых фигур
-                    b += 0.05 * (mtx[i][j] == 2) * (i); // Добавляем потенциал для черных фигур
-                }
+                const uint32_t row = uint32_t(0xF) << (4 * i);
+                w += popcount32(w_men & row) * (7 - i); // Добавляем потенциал для белых фигур
+                b += popcount32(b_men & row) * (i); // Добавляем потенциал для черных фигур
             }
         }
-        if (!first_bot_color) // Если первый бот играет черными
+        if constexpr (!K::black_bot) // Если бот играет белыми
         {
             swap(b, w); // Меняем местами счетчики для черных и белых фигур
             swap(bq, wq); // Меняем местами счетчики для черных и белых дамок
@@ -90,271 +535,354 @@ private:
             return INF; // Возвращаем бесконечность
         if (b + bq == 0) // Если нет черных фигур и дамок
             return 0; // Возвращаем ноль
-        int q_coef = 4; // Коэффициент для дамок
-        if (scoring_mode == "NumberAndPotential") // Если используется режим оценки "NumberAndPotential"
-        {
-            q_coef = 5; // Увеличиваем коэффициент для дамок
-        }
-        return (b + bq * q_coef) / (w + wq * q_coef); // Возвращаем оценку текущего состояния доски
+        constexpr int q_coef = (K::potential ? 5 : 4) * 20; // Коэффициент для дамок, в режиме "NumberAndPotential" увеличен
+        return int(int64_t(b + bq * q_coef) * SCORE_ONE / (w + wq * q_coef)); // Возвращаем оценку текущего состояния доски
     }
-    // Функция для нахождения первого лучшего хода для заданного состояния доски и цвета игрока
-    double find_first_best_turn(vector<vector<POS_T>> mtx, const bool color, const POS_T x, const POS_T y, size_t state,
-        double alpha = -1)
+
+    // Оценка с точки зрения ходящего на глубине depth (на нечетной глубине ходит бот) для негамакса
+    static int side_score(const int score, const size_t depth)
     {
-        // Добавляем текущее состояние в векторы для хранения следующих состояний и ходов
-        next_best_state.push_back(-1);
-        next_move.emplace_back(-1, -1, -1, -1);
+        return depth % 2 ? score : -score;
+    }
 
+    // Функция для нахождения лучшего хода корня (ходы из find_root_turns) для заданного цвета игрока
+    // Возвращает оценку с точки зрения бота (в корне ходит бот) внутри окна (alpha, beta) или границу за ним
+    template <class K>
+    int find_first_best_turn(Position& mtx, const bool color, const int alpha = -INF - 1, const int beta = INF + 1)
+    {
         // Инициализируем лучший результат малым значением
-        double best_score = -1;
-
-        // Если это не начальное состояние, находим все возможные ходы для фигуры на заданных координатах
-        if (state != 0)
-            find_turns(x, y, mtx);
-
-        // Сохраняем найденные ходы и флаг наличия взятий
-        auto turns_now = turns;
-        bool have_beats_now = have_beats;
-
-        // Если нет взятий и это не начальное состояние, рекурсивно вызываем функцию для следующего игрока
-        if (!have_beats_now && state != 0)
-        {
-            return find_best_turns_rec(mtx, 1 - color, 0, alpha);
-        }
-
-        // Векторы для хранения лучших ходов и состояний
-        vector<move_pos> best_moves;
-        vector<int> best_states;
+        int best_score = -INF - 1;
 
         // Проходим по всем доступным ходам
-        for (auto turn : turns_now)
+        for (const auto& turn : root_turns)
         {
-            // Определяем следующее состояние
-            size_t next_state = next_move.size();
+            int score; // Инициализируем оценку текущего хода
+            const int floor = max(alpha, best_score); // Нижняя граница окна для этого хода
 
-            double score; // Инициализируем оценку текущего хода
-
-            // Если есть взятия, рекурсивно вызываем функцию для текущего игрока с новыми координатами
-            if (have_beats_now)
+            const uint32_t undo = do_turn(mtx, turn); // Выполняем ход на месте
+            ++ply;
+            if (!K::pruning || best_score == -INF - 1)
             {
-                score = find_first_best_turn(make_turn(mtx, turn), color, turn.x2, turn.y2, next_state, best_score);
+                // Первый ход ищем с полным окном, чтобы получить точную оценку
+                score = -find_best_turns_rec<K>(mtx, 1 - color, 0, -beta, -floor);
             }
             else
             {
-                // Если нет взятий, рекурсивно вызываем функцию для следующего игрока
-                score = find_best_turns_rec(make_turn(mtx, turn), 1 - color, 0, best_score);
+                // Остальные ходы только проверяем нулевым окном: лучше ли они найденного,
+                // и ищем с полным окном лишь те, что оказались лучше
+                score = -find_best_turns_rec<K>(mtx, 1 - color, 0, -floor - 1, -floor);
+                if (score > floor && score < beta && !stop_search)
+                    score = -find_best_turns_rec<K>(mtx, 1 - color, 0, -beta, -floor);
             }
+            --ply;
+            undo_turn(mtx, turn, undo); // Откатываем ход
+            if (stop_search) // Поиск прерван по времени
+                return best_score;
 
             // Обновляем лучший результат, если текущий ход лучше
             if (score > best_score)
             {
                 best_score = score;
-                // Запоминаем следующее состояние и ход
-                next_best_state[state] = (have_beats_now ? int(next_state) : -1);
-                next_move[state] = turn;
+                best_root_turn = turn;
             }
+            if (K::pruning && best_score >= beta) // Оценка выше окна поиска с ожиданием
+                break;
         }
 
-        // Возвращаем лучший результат для текущего состояния
+        // Возвращаем лучший результат
         return best_score;
     }
 
-    
-    double find_best_turns_rec(vector<vector<POS_T>> mtx, const bool color, const size_t depth, double alpha = -1,
-        double beta = INF + 1, const POS_T x = -1, const POS_T y = -1)
+    // Негамакс с поиском главного варианта: оценка с точки зрения ходящего на глубине depth
+    // Возвращается точная оценка внутри окна (alpha, beta) или граница за ним, не обрезанная по окну (fail-soft)
+    // Серия взятий - один полный ход, поэтому каждый узел - начало хода
+    template <class K>
+    int find_best_turns_rec(Position& mtx, const bool color, const size_t depth, int alpha = -INF - 1,
+        const int beta = INF + 1)
     {
+        if (time_is_up()) // Время вышло, результат итерации все равно будет отброшен
+            return 0;
+        stats.node();
+        if (tb && popcount32(mtx.occupied()) <= tb->max_pieces()) // Точный результат из эндшпильных таблиц
+        {
+            int distance = 0;
+            const TBResult result = tb->probe(mtx, color, distance);
+            if (result != TBResult::UNKNOWN)
+                return side_score(tb_score(result, distance, depth), depth);
+        }
         if (depth == Max_depth) // Если достигнута максимальная глубина поиска
         {
-            return calc_score(mtx, (depth % 2 == color)); // Возвращаем оценку текущего состояния доски
+            return quiescence<K>(mtx, color, depth, alpha, beta); // Оцениваем позицию после разрешения всех обязательных взятий
         }
-        if (x != -1) // Возвращаем оценку текущего состояния доски
+        const bool use_tt = (K::pruning && tt->enabled());
+        const int depth_left = int(Max_depth - depth); // Оставшаяся глубина поиска
+        const uint64_t key = node_key<K>(color);
+        int hash_from = -1, hash_to = -1; // Лучший ход из таблицы
+        if (use_tt)
         {
-            find_turns(x, y, mtx);  // Находим все возможные ходы для этой фигуры
+            tt_entry entry;
+            if (tt->probe(key, entry))
+            {
+                hash_from = entry.from;
+                hash_to = entry.to;
+                const int score = score_from_tt(entry.score, depth);
+                if (entry.depth >= depth_left &&
+                    (entry.bound == Bound::EXACT || (entry.bound == Bound::LOWER && score >= beta) ||
+                     (entry.bound == Bound::UPPER && score <= alpha)))
+                {
+                    horizon_reached = true; // Запись могла быть получена на горизонте поиска
+                    stats.tt_cutoff();
+                    return score; // Оценки из таблицы достаточно для текущего окна
+                }
+            }
         }
-        else
-            find_turns(color, mtx); // Находим все возможные ходы для текущего цвета
-        auto turns_now = turns; // Сохраняем найденные ходы
-        bool have_beats_now = have_beats; // Сохраняем флаг наличия взятий
-
-        if (!have_beats_now && x != -1) // Если нет взятий и заданы координаты фигуры
+        // ProbCut: если поиск на PROBCUT_REDUCTION полуходов мельче нулевым окном дает оценку выше beta
+        // с запасом, считаем, что полный поиск тоже выйдет за окно, и отсекаем узел
+        if constexpr (K::selective)
         {
-            return find_best_turns_rec(mtx, 1 - color, depth + 1, alpha, beta); // Рекурсивно вызываем функцию для следующего игрока
+            if (depth_left >= PROBCUT_MIN_DEPTH && depth > 0)
+            {
+                const int bound = probcut_bound(beta, depth);
+                if (bound != INF + 1)
+                {
+                    Max_depth -= PROBCUT_REDUCTION;
+                    const int score = find_best_turns_rec<K>(mtx, color, depth, bound - 1, bound);
+                    Max_depth += PROBCUT_REDUCTION;
+                    if (stop_search)
+                        return 0;
+                    if (score >= bound)
+                    {
+                        stats.probcut();
+                        return score;
+                    }
+                }
+            }
         }
+        // Находим полные ходы в буфер текущего уровня
+        vector<full_move>& turns_now = ply_buffer();
+        const bool have_beats_now = MoveGen::generate_full(mtx, color, turns_now); // Флаг наличия взятий
+
+        if (turns_now.empty()) // Если нет доступных ходов, ходящий проиграл
+            return side_score(end_score(depth % 2 == 0, int(depth)), depth);
 
-        if (turns.empty()) // Если нет доступных ходов
-            return (depth % 2 ? 0 : INF); // Возвращаем значение в зависимости от текущего игрока
+        order_turns(mtx, color, turns_now, hash_from, hash_to); // Лучшие по эвристикам ходы проверяем первыми
 
-        double min_score = INF + 1; // Инициализируем минимальную оценку большим значением
-        double max_score = -1; // Инициализируем максимальную оценку малым значением
-        for (auto turn : turns_now) // Проходим по всем доступным хода
+        const int alpha_start = alpha; // Исходное окно для определения типа оценки
+        int best_score = -INF - 1; // Инициализируем лучшую оценку малым значением
+        const full_move* best_turn = nullptr; // Лучший ход в узле
+        for (size_t i = 0; i < turns_now.size(); ++i) // Проходим по всем доступным хода
         {
-            double score = 0.0; // Инициализируем оценку текущего хода
-            if (!have_beats_now && x == -1) // Если нет взятий и не заданы координаты фигуры
+            pick_turn(turns_now, i);
+            const full_move& turn = turns_now[i];
+            int score = 0; // Инициализируем оценку текущего хода
+            const uint32_t undo = do_turn(mtx, turn); // Выполняем ход на месте
+            ++ply;
+            if (!K::pruning || i == 0) // Первый ход (главный вариант) ищем с полным окном
             {
-                score = find_best_turns_rec(make_turn(mtx, turn), 1 - color, depth + 1, alpha, beta);  // Рекурсивно вызываем функцию для следующего игрока
+                score = -find_best_turns_rec<K>(mtx, 1 - color, depth + 1, -beta, -alpha);
             }
             else
             {
-                score = find_best_turns_rec(make_turn(mtx, turn), color, depth, alpha, beta, turn.x2, turn.y2); // Рекурсивно вызываем функцию для текущего игрока
+                // Сокращение поздних ходов: тихие ходы в конце списка (не из таблицы, не киллеры и не превращения)
+                // сначала ищутся на меньшую глубину - горизонт поддерева временно приближается
+                int reduction = 0;
+                if constexpr (K::selective)
+                {
+                    if (depth_left >= LMR_MIN_DEPTH && int(i) >= lmr_moves && ply_order[ply - 1][i] < ORDER_PROMOTION)
+                        reduction = min(int(i) >= 2 * lmr_moves && depth_left >= 2 * LMR_MIN_DEPTH ? 2 : 1,
+                                        depth_left - 1);
+                }
+                if (reduction)
+                {
+                    Max_depth -= reduction;
+                    score = -find_best_turns_rec<K>(mtx, 1 - color, depth + 1, -alpha - 1, -alpha);
+                    Max_depth += reduction;
+                    stats.reduction();
+                }
+                // Остальные ходы проверяем нулевым окном (лучше ли они alpha), ход лучше ожидаемого
+                // перепроверяем на полной глубине, а затем с полным окном, если его оценка внутри окна
+                if (!reduction || (score > alpha && !stop_search))
+                {
+                    if (reduction)
+                        stats.research();
+                    score = -find_best_turns_rec<K>(mtx, 1 - color, depth + 1, -alpha - 1, -alpha);
+                }
+                if (score > alpha && score < beta && !stop_search)
+                    score = -find_best_turns_rec<K>(mtx, 1 - color, depth + 1, -beta, -alpha);
+            }
+            --ply;
+            undo_turn(mtx, turn, undo); // Откатываем ход
+            if (stop_search) // Поиск прерван по времени
+                return 0;
+            if (score > best_score) // Запоминаем лучший ход для текущего игрока
+            {
+                best_score = score;
+                best_turn = &turn;
+            }
+            alpha = max(alpha, score); // Обновляем альфа
+            if (K::pruning && alpha >= beta) // Если включена оптимизация и альфа больше или равно бета
+            {
+                stats.cutoff(i);
+                if (!have_beats_now)
+                    update_cutoff_stats(color, turn, depth_left);
+                break; // Прерываем поиск, результат уже вне окна
             }
-            min_score = min(min_score, score); // Обновляем минимальную оценку
-            max_score = max(max_score, score); // Обновляем максимальную оценку
-            // alpha-beta pruning
-            if (depth % 2)  // Если текущий игрок максимизирующий
-                alpha = max(alpha, max_score); // Обновляем альфа
-            else
-                beta = min(beta, min_score); // Обновляем бета
-            if (optimization != "O0" && alpha >= beta) // Если включена оптимизация и альфа больше или равно бета
-                return (depth % 2 ? max_score + 1 : min_score - 1); // Прерываем поиск и возвращаем результат
         }
-        return (depth % 2 ? max_score : min_score); // Возвращаем результат в зависимости от текущего игрока
+        if (use_tt) // Сохраняем результат с типом оценки относительно исходного окна
+        {
+            const Bound bound =
+                best_score <= alpha_start ? Bound::UPPER : (best_score >= beta ? Bound::LOWER : Bound::EXACT);
+            tt->store(key, depth_left, bound, score_to_tt(best_score, depth), best_turn->from, best_turn->to);
+        }
+        return best_score;
     }
-    
-public:
-    // Нахождение всех возможных ходов для заданного цвета на текущей доске
-    void find_turns(const bool color)
+
+    // Граница ProbCut для окна с верхней границей beta на глубине depth или INF + 1, если проба не нужна
+    // Оценка - отношение сил, поэтому запас относительный: отношение сил ходящего должно быть
+    // в probcut_scale / SCORE_ONE раз лучше, чем на границе окна. Окна у оценок конца партии пропускаются
+    int probcut_bound(const int beta, const size_t depth) const
     {
-        find_turns(color, board->get_board()); // Вызов вспомогательной функции с текущей матрицей доски
+        const int bot_beta = side_score(beta, depth); // Граница окна с точки зрения бота
+        if (beta > INF || bot_beta < MATE_PLIES || bot_beta > INF - MATE_PLIES)
+            return INF + 1;
+        const int64_t ratio = depth % 2 ? int64_t(bot_beta) * probcut_scale / SCORE_ONE
+                                        : int64_t(bot_beta) * SCORE_ONE / probcut_scale;
+        const int bound = int(min<int64_t>(ratio, INF - MATE_PLIES - 1));
+        return side_score(max(bound, MATE_PLIES), depth);
     }
 
-    // Нахождение всех возможных ходов для фигуры на заданных координатах на текущей доске
-    void find_turns(const POS_T x, const POS_T y)
+    // Оценка позиции по результату из эндшпильных таблиц с точки зрения бота на глубине depth
+    // Ничья оценивается как равенство сил
+    int tb_score(const TBResult result, const int distance, const size_t depth) const
     {
-        find_turns(x, y, board->get_board()); // Вызов вспомогательной функции с текущей матрицей доски
+        if (result == TBResult::DRAW)
+            return SCORE_ONE;
+        const bool bot_wins = (result == TBResult::WIN) == (depth % 2 == 1); // На нечетной глубине ходит бот
+        return end_score(bot_wins, int(depth) + distance);
     }
 
-private:
-    // Вспомогательная функция для поиска всех возможных ходов для заданного цвета на заданной матрице доски
-    void find_turns(const bool color, const vector<vector<POS_T>>& mtx)
+    // Оценка конца партии через plies полуходов с точки зрения бота: быстрый выигрыш лучше долгого,
+    // а долгий проигрыш лучше быстрого (бот выбирает самую упорную защиту)
+    static int end_score(const bool bot_wins, const int plies)
     {
-        vector<move_pos> res_turns; // Вектор для хранения найденных ходов
-        bool have_beats_before = false; // Флаг наличия взятий до начала поиска
-        for (POS_T i = 0; i < 8; ++i) // Проходим по всем клеткам доски
-        {
-            for (POS_T j = 0; j < 8; ++j)
-            {
-                if (mtx[i][j] && mtx[i][j] % 2 != color) // Если клетка занята фигурой заданного цвета
-                {
-                    find_turns(i, j, mtx); // Находим все возможные ходы для этой фигуры
-                    if (have_beats && !have_beats_before) // Если есть взятия и это первое взятие
-                    {
-                        have_beats_before = true;
-                        res_turns.clear(); // Очищаем предыдущие ходы
-                    }
-                    if ((have_beats_before && have_beats) || !have_beats_before) // Добавляем найденные ходы в результирующий вектор
-                    {
-                        res_turns.insert(res_turns.end(), turns.begin(), turns.end());
-                    }
-                }
-            }
-        }
-        turns = res_turns; // Сохраняем найденные ходы
-        shuffle(turns.begin(), turns.end(), rand_eng); // Перемешиваем ходы для случайности
-        have_beats = have_beats_before; // Обновляем флаг наличия взятий
+        const int n = min(plies, MATE_PLIES - 1);
+        return bot_wins ? INF - n : n;
+    }
+
+    // Оценка конца партии в таблице транспозиций хранится как расстояние от узла, а не от корня,
+    // чтобы запись, сделанная на одной глубине, была верна на любой другой
+    static int score_to_tt(const int score, const size_t depth)
+    {
+        return side_score(shift_end_score(side_score(score, depth), int(depth)), depth);
+    }
+
+    static int score_from_tt(const int score, const size_t depth)
+    {
+        return side_score(shift_end_score(side_score(score, depth), -int(depth)), depth);
+    }
+
+    // Перенос оценки конца партии (с точки зрения бота) на plies полуходов ближе к корню
+    static int shift_end_score(const int score, const int plies)
+    {
+        if (score >= INF - MATE_PLIES)
+            return score + plies;
+        if (score >= 0 && score < MATE_PLIES)
+            return score - plies;
+        return score;
     }
 
-    // Вспомогательная функция для поиска всех возможных ходов для фигуры на заданных координатах на заданной матрице доски
-    void find_turns(const POS_T x, const POS_T y, const vector<vector<POS_T>>& mtx)
+    // Поиск за горизонтом только по взятиям: пока у ходящей стороны есть обязательные взятия, они перебираются,
+    // и оценка вычисляется только в спокойной позиции. Каждое взятие убирает фигуру, поэтому поиск конечен
+    // Оценка, как и в основном поиске, с точки зрения ходящего
+    template <class K> int quiescence(Position& mtx, const bool color, const size_t depth, int alpha, const int beta)
     {
-        turns.clear(); // Очищаем вектор ходов
-        have_beats = false; // Сбрасываем флаг наличия взятий
-        POS_T type = mtx[x][y]; // Тип фигуры на заданных координатах
-        // Проверка взятий
-        switch (type)
+        if (time_is_up()) // Время вышло, результат итерации все равно будет отброшен
+            return 0;
+        stats.quiescence_node();
+        vector<full_move>& turns_now = ply_buffer();
+        const bool have_beats_now = MoveGen::generate_full(mtx, color, turns_now); // Флаг наличия взятий
+        if (!have_beats_now)
         {
-        case 1:  // Белая фигура
-        case 2: // Черная фигура
-            // Проверка обычных фигур
-            for (POS_T i = x - 2; i <= x + 2; i += 4)
-            {
-                for (POS_T j = y - 2; j <= y + 2; j += 4)
-                {
-                    if (i < 0 || i > 7 || j < 0 || j > 7) // Проверка выхода за границы доски
-                        continue;
-                    POS_T xb = (x + i) / 2, yb = (y + j) / 2; // Координаты взятой фигуры
-                    if (mtx[i][j] || !mtx[xb][yb] || mtx[xb][yb] % 2 == type % 2) // Проверка возможности взятия
-                        continue;
-                    turns.emplace_back(x, y, i, j, xb, yb); // Добавляем ход в вектор
-                }
-            }
-            break;
-        default:
-            // Дамка
-            for (POS_T i = -1; i <= 1; i += 2)
-            {
-                for (POS_T j = -1; j <= 1; j += 2)
-                {
-                    POS_T xb = -1, yb = -1;
-                    for (POS_T i2 = x + i, j2 = y + j; i2 != 8 && j2 != 8 && i2 != -1 && j2 != -1; i2 += i, j2 += j)
-                    {
-                        if (mtx[i2][j2]) // Если клетка занята
-                        {
-                            if (mtx[i2][j2] % 2 == type % 2 || (mtx[i2][j2] % 2 != type % 2 && xb != -1))  // Проверка возможности взятия
-                            {
-                                break;
-                            }
-                            xb = i2;
-                            yb = j2;
-                        }
-                        if (xb != -1 && xb != i2) // Если есть взятие
-                        {
-                            turns.emplace_back(x, y, i2, j2, xb, yb); // Добавляем ход в вектор
-                        }
-                    }
-                }
-            }
-            break;
+            horizon_reached = true;
+            if (turns_now.empty()) // Если нет доступных ходов, ходящий проиграл
+                return side_score(end_score(depth % 2 == 0, int(depth)), depth);
+            stats.eval();
+            return side_score(calc_score<K>(mtx), depth); // Возвращаем оценку спокойной позиции
         }
-        // Проверка других ходов
-        if (!turns.empty())
+
+        order_turns(mtx, color, turns_now, -1, -1);
+        int best_score = -INF - 1; // Инициализируем лучшую оценку малым значением
+        for (size_t i = 0; i < turns_now.size(); ++i) // Проходим по всем взятиям
         {
-            have_beats = true; // Устанавливаем флаг наличия взятий
-            return;
+            pick_turn(turns_now, i);
+            const full_move& turn = turns_now[i];
+            const uint32_t undo = do_turn(mtx, turn); // Выполняем взятие на месте
+            ++ply;
+            const int score = -quiescence<K>(mtx, 1 - color, depth + 1, -beta, -alpha); // Ход переходит к противнику
+            --ply;
+            undo_turn(mtx, turn, undo); // Откатываем ход
+            if (stop_search) // Поиск прерван по времени
+                return 0;
+            best_score = max(best_score, score); // Обновляем лучшую оценку
+            alpha = max(alpha, score); // Обновляем альфа
+            if (K::pruning && alpha >= beta) // Если включена оптимизация и альфа больше или равно бета
+                break; // Прерываем поиск, результат уже вне окна
         }
-        switch (type)
-        {
-        case 1: // Белая фигура
-        case 2: // Черная фигура
-            // Проверка обычных фигур
+        return best_score; // Возвращаем лучшую оценку ходящего
+    }
+
+public:
+    // Нахождение всех возможных ходов для заданного цвета на заданной позиции
+    void find_turns(const bool color, const Position& mtx)
+    {
+        have_beats = gen_turns(mtx, color, -1, -1, turns); // Генерируем ходы сразу для всех фигур цвета
+    }
+
+    // Нахождение всех возможных ходов для фигуры на заданных координатах на заданной позиции
+    void find_turns(const POS_T x, const POS_T y, const Position& mtx)
+    {
+        const POS_T type = mtx.get(x, y); // Тип фигуры на заданных координатах
+        if (!type)
         {
-            POS_T i = ((type % 2) ? x - 1 : x + 1);
-            for (POS_T j = y - 1; j <= y + 1; j += 2)
-            {
-                if (i < 0 || i > 7 || j < 0 || j > 7 || mtx[i][j]) // Проверка выхода за границы доски и занятости клетки
-                    continue;
-                turns.emplace_back(x, y, i, j); // Добавляем ход в вектор
-            }
-            break;
-        }
-        default: // Дамка
-            // Проверка дамок
-            for (POS_T i = -1; i <= 1; i += 2)
-            {
-                for (POS_T j = -1; j <= 1; j += 2)
-                {
-                    for (POS_T i2 = x + i, j2 = y + j; i2 != 8 && j2 != 8 && i2 != -1 && j2 != -1; i2 += i, j2 += j)
-                    {
-                        if (mtx[i2][j2]) // Если клетка занята
-                            break;
-                        turns.emplace_back(x, y, i2, j2); // Добавляем ход в вектор
-                    }
-                }
-            }
-            break;
+            turns.clear();
+            have_beats = false;
+            return;
         }
+        have_beats = gen_turns(mtx, type % 2 == 0, x, y, turns);
     }
 
 public:
     vector<move_pos> turns; // Вектор для хранения всех возможных ходов
     bool have_beats; // Флаг наличия взятийl
     int Max_depth;// Максимальная глубина поиска
+    double last_score = 0; // Оценка лучшего хода последнего поиска с точки зрения бота (около INF - победа, около 0 - поражение)
+    uint64_t nodes = 0; // Число узлов последнего поиска в основном потоке (для проверки времени и замеров)
+    SearchStats stats; // Подробная статистика последнего поиска (собирается только с флагом SEARCH_STATS)
 
 private:
     default_random_engine rand_eng; // Генератор случайных чисел
-    string scoring_mode; // Режим оценки текущего состояния доски
-    string optimization; // Уровень оптимизации алгоритма
-    vector<move_pos> next_move; // Вектор для хранения следующих ходов
-    vector<int> next_best_state; // Вектор для хранения следующих состояний доски
-    Board* board; // Указатель на объект доски
+    Scoring scoring; // Режим оценки текущего состояния доски
+    Optimization optimization; // Уровень оптимизации алгоритма
+    RootSearch root_search[2]; // Специализации поиска для белого и черного бота
+    vector<full_move> root_turns; // Полные ходы корня поиска
+    full_move best_root_turn; // Лучший ход корня последнего поиска
+    deque<vector<full_move>> ply_turns; // Буферы ходов по уровням рекурсии (deque не перемещает буферы при росте)
+    deque<vector<int>> ply_order; // Оценки ходов для упорядочивания по уровням рекурсии
+    vector<array<int, 2>> killers; // Два киллер-хода (from * 32 + to) на каждый уровень рекурсии
+    int history[2][32][32] = {}; // История отсечений тихих ходов по цвету и клеткам хода
+    bool no_random = false; // Детерминированный бот
+    int lmr_moves = 3; // O2: номер хода в списке, начиная с которого тихие ходы ищутся с сокращением
+    int probcut_scale = SCORE_ONE * 6 / 5; // O2: множитель ProbCut к отношению сил на границе окна (1 + запас)
+    size_t ply = 0; // Текущий уровень рекурсии поиска
+    shared_ptr<TTable> tt; // Таблица транспозиций, общая для копий логики во вспомогательных потоках
+    shared_ptr<const Tablebase> tb; // Эндшпильные таблицы (nullptr - не загружены)
+    shared_ptr<const Book> book; // Дебютная книга (nullptr - не загружена)
+    int threads = 1; // Количество потоков поиска
+    const atomic<bool>* stop_signal = nullptr; // Сигнал остановки вспомогательного потока или отмены поиска
+    uint64_t hash_key = 0; // Ключ Зобриста текущей позиции поиска
+    int time_ms = 0; // Время на ход в миллисекундах (0 - поиск на фиксированную глубину)
+    chrono::steady_clock::time_point deadline; // Момент, к которому поиск должен завершиться
+    bool stop_search = false; // Поиск прерван по времени
+    bool horizon_reached = false; // В итерации был достигнут горизонт поиска
     Config* config; // Указатель на объект конфигурации
 };
\ No newline at end of file
@@ -0,0 +1,352 @@
+#pragma once
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+#include "../Models/Move.h"
+#include "../Models/Position.h"
+
+using namespace std;
+
+// Направления диагоналей: 0 - вверх-влево, 1 - вверх-вправо, 2 - вниз-влево, 3 - вниз-вправо
+// Противоположное направлению d имеет номер 3 - d
+const int DIR_UL = 0, DIR_UR = 1, DIR_DL = 2, DIR_DR = 3;
+
+// Таблица лучей по диагоналям для каждой игровой клетки, строится на этапе компиляции
+struct RayTable
+{
+    int8_t sq[4][32][7]; // Клетки луча в порядке удаления от начальной
+    int8_t len[4][32];   // Длина луча до края доски
+};
+
+constexpr RayTable make_ray_table()
+{
+    RayTable table{};
+    const int dx[4] = {-1, -1, 1, 1};
+    const int dy[4] = {-1, 1, -1, 1};
+    for (int d = 0; d < 4; ++d)
+    {
+        for (int s = 0; s < 32; ++s)
+        {
+            int len = 0;
+            for (int x = Position::square_x(s) + dx[d], y = Position::square_y(s) + dy[d];
+                 x >= 0 && x < 8 && y >= 0 && y < 8; x += dx[d], y += dy[d])
+            {
+                table.sq[d][s][len++] = int8_t(Position::square(POS_T(x), POS_T(y)));
+            }
+            table.len[d][s] = int8_t(len);
+        }
+    }
+    return table;
+}
+
+inline constexpr RayTable RAYS = make_ray_table();
+
+// Генератор ходов, работающий сразу со множествами фигур
+class MoveGen
+{
+  public:
+    // Маски строк и столбцов для сдвигов (четные строки 0, 2, 4, 6 и крайние столбцы в нумерации битов)
+    static constexpr uint32_t EVEN_ROWS = 0x0F0F0F0Fu;
+    static constexpr uint32_t ODD_ROWS = 0xF0F0F0F0u;
+    static constexpr uint32_t COL_FIRST = 0x11111111u;
+    static constexpr uint32_t COL_LAST = 0x88888888u;
+
+    // Сдвиг множества клеток на одну клетку по диагонали d
+    static uint32_t step(const int d, const uint32_t m)
+    {
+        switch (d)
+        {
+        case DIR_UL:
+            return ((m & EVEN_ROWS) >> 4) | ((m & ODD_ROWS & ~COL_FIRST) >> 5);
+        case DIR_UR:
+            return ((m & EVEN_ROWS & ~COL_LAST) >> 3) | ((m & ODD_ROWS) >> 4);
+        case DIR_DL:
+            return ((m & EVEN_ROWS) << 4) | ((m & ODD_ROWS & ~COL_FIRST) << 3);
+        default:
+            return ((m & EVEN_ROWS & ~COL_LAST) << 5) | ((m & ODD_ROWS) << 4);
+        }
+    }
+
+    // Генерация всех ходов фигур цвета color из множества from с учетом обязательного взятия
+    // Возвращает true, если найдены взятия (тогда в turns только взятия)
+    static bool generate(const Position &mtx, const bool color, const uint32_t from, vector<move_pos> &turns)
+    {
+        turns.clear();
+        const uint32_t own = mtx.pieces(color) & from;
+        const uint32_t opp = mtx.pieces(!color);
+        const uint32_t empty = ~mtx.occupied();
+        const uint32_t men = own & ~mtx.kings;
+        const uint32_t kings = own & mtx.kings;
+
+        // Взятия простыми фигурами во всех четырех направлениях
+        for (int d = 0; d < 4; ++d)
+        {
+            uint32_t land = step(d, step(d, men) & opp) & empty;
+            for (; land; land &= land - 1)
+            {
+                const int to = lsb_index(land);
+                const int xb = RAYS.sq[3 - d][to][0];
+                add_turn(turns, RAYS.sq[3 - d][xb][0], to, xb);
+            }
+        }
+        // Взятия дамками: летят по лучу до первой фигуры противника и встают на любую свободную клетку за ней
+        for (uint32_t k = kings; k; k &= k - 1)
+        {
+            const int s = lsb_index(k);
+            for (int d = 0; d < 4; ++d)
+            {
+                const int8_t *ray = RAYS.sq[d][s];
+                const int len = RAYS.len[d][s];
+                int i = 0;
+                while (i < len && (empty >> ray[i] & 1))
+                    ++i;
+                if (i == len || !(opp >> ray[i] & 1))
+                    continue;
+                const int xb = ray[i];
+                for (++i; i < len && (empty >> ray[i] & 1); ++i)
+                    add_turn(turns, s, ray[i], xb);
+            }
+        }
+        if (!turns.empty())
+            return true;
+        quiet_moves(color, men, kings, empty, [&](const int s, const int to, bool) { add_turn(turns, s, to); });
+        return false;
+    }
+
+    // Генерация всех полных ходов цвета color: серия взятий одной фигуры порождает один ход со всеми взятыми
+    // фигурами. Серии с разным порядком взятий или разными промежуточными клетками дамки, которые приводят
+    // к одной и той же позиции, дают один ход. Возвращает true, если ходы - взятия
+    static bool generate_full(const Position &mtx, const bool color, vector<full_move> &turns)
+    {
+        turns.clear();
+        const uint32_t own = mtx.pieces(color);
+        const uint32_t opp = mtx.pieces(!color);
+        for (uint32_t p = own; p; p &= p - 1)
+        {
+            const int s = lsb_index(p);
+            full_move turn;
+            turn.from = int8_t(s);
+            capture_rec(color, s, (mtx.kings >> s & 1) != 0, opp, mtx.occupied() & ~(uint32_t(1) << s), turn, turns);
+        }
+        if (!turns.empty())
+            return true;
+
+        quiet_moves(color, own & ~mtx.kings, own & mtx.kings, ~mtx.occupied(),
+                    [&](const int s, const int to, const bool promotes) {
+                        full_move turn;
+                        turn.from = int8_t(s);
+                        turn.to = int8_t(to);
+                        turn.promotes = promotes;
+                        turns.push_back(turn);
+                    });
+        return false;
+    }
+
+    // Выполнение полного хода на позиции, возвращает взятые дамки для отката
+    static uint32_t make_full(Position &mtx, const full_move &turn)
+    {
+        const uint32_t from = uint32_t(1) << turn.from, to = uint32_t(1) << turn.to;
+        const bool color = (mtx.black & from) != 0;
+        const uint32_t beaten_kings = mtx.kings & turn.captured;
+        (color ? mtx.white : mtx.black) &= ~turn.captured;
+        mtx.kings &= ~turn.captured;
+        const bool king = (mtx.kings & from) || turn.promotes;
+        (color ? mtx.black : mtx.white) ^= from ^ to; // Серия может закончиться на начальной клетке
+        mtx.kings &= ~from;
+        if (king)
+            mtx.kings |= to;
+        return beaten_kings;
+    }
+
+    // Откат полного хода, выполненного make_full
+    static void unmake_full(Position &mtx, const full_move &turn, const uint32_t beaten_kings)
+    {
+        const uint32_t from = uint32_t(1) << turn.from, to = uint32_t(1) << turn.to;
+        const bool color = (mtx.black & to) != 0;
+        const bool king = (mtx.kings & to) && !turn.promotes;
+        mtx.kings &= ~to;
+        (color ? mtx.black : mtx.white) ^= from ^ to;
+        if (king)
+            mtx.kings |= from;
+        (color ? mtx.white : mtx.black) |= turn.captured;
+        mtx.kings |= beaten_kings;
+    }
+
+    // Выполнение одного хода (одного взятия серии) на позиции, возвращает сведения для его отката
+    static move_undo make_turn(Position &mtx, const move_pos &turn)
+    {
+        move_undo undo;
+        const uint32_t from = uint32_t(1) << Position::square(turn.x, turn.y);
+        const uint32_t to = uint32_t(1) << Position::square(turn.x2, turn.y2);
+        const bool color = (mtx.black & from) != 0;
+        if (turn.xb != -1)
+        {
+            const uint32_t beaten = uint32_t(1) << Position::square(turn.xb, turn.yb);
+            undo.beaten_king = (mtx.kings & beaten) != 0;
+            (color ? mtx.white : mtx.black) &= ~beaten;
+            mtx.kings &= ~beaten;
+        }
+        (color ? mtx.black : mtx.white) ^= from | to;
+        if (mtx.kings & from)
+            mtx.kings ^= from | to;
+        else if (turn.x2 == (color ? 7 : 0)) // Превращение в дамку на последней горизонтали
+        {
+            mtx.kings |= to;
+            undo.promoted = true;
+        }
+        return undo;
+    }
+
+    // Откат хода, выполненного make_turn
+    static void unmake_turn(Position &mtx, const move_pos &turn, const move_undo &undo)
+    {
+        const uint32_t from = uint32_t(1) << Position::square(turn.x, turn.y);
+        const uint32_t to = uint32_t(1) << Position::square(turn.x2, turn.y2);
+        const bool color = (mtx.black & to) != 0;
+        if (undo.promoted)
+            mtx.kings &= ~to;
+        else if (mtx.kings & to)
+            mtx.kings ^= from | to;
+        (color ? mtx.black : mtx.white) ^= from | to;
+        if (turn.xb != -1)
+        {
+            const uint32_t beaten = uint32_t(1) << Position::square(turn.xb, turn.yb);
+            (color ? mtx.white : mtx.black) |= beaten;
+            if (undo.beaten_king)
+                mtx.kings |= beaten;
+        }
+    }
+
+    // Все полные ходы цвета color (серия взятий одной фигуры - один ход): серия и позиция после нее
+    static void full_turns(const Position &mtx, const bool color, vector<pair<vector<move_pos>, Position>> &res)
+    {
+        res.clear();
+        vector<move_pos> series;
+        full_turns_rec(mtx, color, -1, -1, series, res);
+    }
+
+    // Серия ходов для доски, выполняющая полный ход turn цвета color (пустая, если такого хода нет)
+    static vector<move_pos> series_of(const Position &mtx, const bool color, const full_move &turn)
+    {
+        Position next = mtx;
+        make_full(next, turn);
+        vector<pair<vector<move_pos>, Position>> all;
+        full_turns(mtx, color, all);
+        for (const auto &series : all)
+        {
+            if (series.second == next)
+                return series.first;
+        }
+        return {};
+    }
+
+  private:
+    // Тихие ходы простых фигур men и дамок kings цвета color на свободные клетки empty:
+    // для каждого хода вызывается add(откуда, куда, превращение в дамку)
+    template <class Add>
+    static void quiet_moves(const bool color, const uint32_t men, const uint32_t kings, const uint32_t empty, Add add)
+    {
+        const int last_row = color ? 7 : 0;
+        // Тихие ходы простых фигур: белые идут вверх, черные вниз
+        const int dirs[2] = {color ? DIR_DL : DIR_UL, color ? DIR_DR : DIR_UR};
+        for (int d : dirs)
+        {
+            for (uint32_t to = step(d, men) & empty; to; to &= to - 1)
+            {
+                const int s = lsb_index(to);
+                add(RAYS.sq[3 - d][s][0], s, Position::square_x(s) == last_row);
+            }
+        }
+        // Тихие ходы дамок на любую свободную клетку луча
+        for (uint32_t k = kings; k; k &= k - 1)
+        {
+            const int s = lsb_index(k);
+            for (int d = 0; d < 4; ++d)
+            {
+                const int8_t *ray = RAYS.sq[d][s];
+                for (int i = 0; i < RAYS.len[d][s] && (empty >> ray[i] & 1); ++i)
+                    add(s, int(ray[i]), false);
+            }
+        }
+    }
+
+    // Продолжение серии взятий фигурой на клетке s: opp - оставшиеся фигуры противника, occ - занятые клетки
+    // без ходящей фигуры. Взятая фигура снимается сразу (как в make_turn), превратившись в дамку посреди
+    // серии, фигура бьет дальше как дамка. Законченная серия добавляется в turns, если такого хода еще нет
+    static void capture_rec(const bool color, const int s, const bool king, const uint32_t opp, const uint32_t occ,
+                            full_move &turn, vector<full_move> &turns)
+    {
+        const uint32_t empty = ~(occ | uint32_t(1) << s);
+        bool found = false;
+        for (int d = 0; d < 4; ++d)
+        {
+            const int8_t *ray = RAYS.sq[d][s];
+            const int len = RAYS.len[d][s];
+            int i = 0;
+            if (king) // Дамка летит по лучу до первой фигуры
+            {
+                while (i < len && (empty >> ray[i] & 1))
+                    ++i;
+            }
+            if (i + 1 >= len || !(opp >> ray[i] & 1))
+                continue;
+            const uint32_t beaten = uint32_t(1) << ray[i];
+            const bool promotes = turn.promotes;
+            // Простая фигура встает сразу за взятой, дамка - на любую свободную клетку за ней
+            for (int j = i + 1; j < len && (empty >> ray[j] & 1) && (king || j == i + 1); ++j)
+            {
+                found = true;
+                const bool promoted = !king && Position::square_x(ray[j]) == (color ? 7 : 0);
+                turn.captured |= beaten;
+                turn.promotes = promotes || promoted;
+                capture_rec(color, ray[j], king || promoted, opp & ~beaten, occ & ~beaten, turn, turns);
+                turn.captured &= ~beaten;
+                turn.promotes = promotes;
+            }
+        }
+        if (found || !turn.captured)
+            return;
+        turn.to = int8_t(s);
+        for (const auto &other : turns) // Та же позиция уже получена другой серией
+        {
+            if (other == turn)
+                return;
+        }
+        turns.push_back(turn);
+    }
+
+    static void full_turns_rec(const Position &mtx, const bool color, const POS_T x, const POS_T y,
+                               vector<move_pos> &series, vector<pair<vector<move_pos>, Position>> &res)
+    {
+        vector<move_pos> turns;
+        const bool have_beats =
+            generate(mtx, color, x == -1 ? ~uint32_t(0) : uint32_t(1) << Position::square(x, y), turns);
+        if (x != -1 && !have_beats) // Серия взятий закончилась
+        {
+            res.emplace_back(series, mtx);
+            return;
+        }
+        for (const auto &turn : turns)
+        {
+            Position next = mtx;
+            make_turn(next, turn);
+            series.push_back(turn);
+            if (have_beats)
+                full_turns_rec(next, color, turn.x2, turn.y2, series, res);
+            else
+                res.emplace_back(series, next);
+            series.pop_back();
+        }
+    }
+
+    static void add_turn(vector<move_pos> &turns, const int from, const int to, const int beaten = -1)
+    {
+        if (beaten == -1)
+            turns.emplace_back(Position::square_x(from), Position::square_y(from), Position::square_x(to),
+                               Position::square_y(to));
+        else
+            turns.emplace_back(Position::square_x(from), Position::square_y(from), Position::square_x(to),
+                               Position::square_y(to), Position::square_x(beaten), Position::square_y(beaten));
+    }
+};
@@ -0,0 +1,168 @@
+#pragma once
+#include <stdint.h>
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include "../Models/Move.h"
+#include "../Models/Position.h"
+#include "MoveGen.h"
+
+using namespace std;
+
+// Подсчет листьев дерева ходов (perft) для проверки и замера генератора ходов
+// Один ход - полная серия взятий одной фигуры: после взятия фигура бьет дальше, пока может,
+// превратившись в дамку посреди серии, продолжает бить как дамка (так же, как в Logic).
+// Обычный подсчет перебирает серии по одному взятию (MoveGen::generate и make_turn), поэтому разные серии,
+// приводящие к одной позиции, дают разные листья. Подсчет полных ходов (count_full) идет по ходам поиска:
+// MoveGen::generate_full, где такие серии - один ход, и make_full/unmake_full на одной позиции
+class Perft
+{
+  public:
+    // Количество позиций на глубине depth полных ходов от позиции mtx, color - очередь хода
+    uint64_t count(const Position &mtx, const bool color, const int depth)
+    {
+        return count_rec(mtx, color, depth, 0);
+    }
+
+    // Количество позиций для каждого хода из корня: вызывает callback(серия ходов, количество)
+    void divide(const Position &mtx, const bool color, const int depth,
+                const function<void(const vector<move_pos> &, uint64_t)> &callback)
+    {
+        vector<move_pos> series;
+        divide_rec(mtx, color, -1, -1, depth, 0, series, callback);
+    }
+
+    // Количество позиций на глубине depth полных ходов поиска. Каждый ход выполняется и откатывается
+    // на месте, позиция, не восстановленная откатом, учитывается в unmake_errors
+    uint64_t count_full(const Position &mtx, const bool color, const int depth)
+    {
+        Position pos = mtx;
+        return count_full_rec(pos, color, depth, 0);
+    }
+
+    // Количество позиций для каждого полного хода из корня: вызывает callback(ход, количество)
+    void divide_full(const Position &mtx, const bool color, const int depth,
+                     const function<void(const full_move &, uint64_t)> &callback)
+    {
+        Position pos = mtx;
+        vector<full_move> turns;
+        MoveGen::generate_full(pos, color, turns);
+        for (const auto &turn : turns)
+        {
+            const uint32_t beaten_kings = MoveGen::make_full(pos, turn);
+            const uint64_t nodes = count_full_rec(pos, !color, depth - 1, 1);
+            MoveGen::unmake_full(pos, turn, beaten_kings);
+            check_restored(pos, mtx);
+            callback(turn, nodes);
+        }
+    }
+
+    uint64_t unmake_errors = 0; // Откаты полных ходов, не восстановившие позицию
+
+  private:
+    // Буфер ходов для уровня рекурсии (уровень растет и по ходам, и по шагам серии взятий)
+    vector<move_pos> &buffer(const size_t level)
+    {
+        while (buffers.size() <= level)
+            buffers.emplace_back();
+        return buffers[level];
+    }
+
+    uint64_t count_rec(const Position &mtx, const bool color, const int depth, const size_t level)
+    {
+        if (depth == 0)
+            return 1;
+        vector<move_pos> &turns = buffer(level);
+        const bool have_beats = MoveGen::generate(mtx, color, ~uint32_t(0), turns);
+        uint64_t nodes = 0;
+        for (const auto &turn : turns)
+        {
+            Position next = mtx;
+            MoveGen::make_turn(next, turn);
+            nodes += have_beats ? series_rec(next, color, turn.x2, turn.y2, depth, level + 1)
+                                : count_rec(next, !color, depth - 1, level + 1);
+        }
+        return nodes;
+    }
+
+    vector<full_move> &full_buffer(const size_t level)
+    {
+        while (full_buffers.size() <= level)
+            full_buffers.emplace_back();
+        return full_buffers[level];
+    }
+
+    uint64_t count_full_rec(Position &mtx, const bool color, const int depth, const size_t level)
+    {
+        if (depth == 0)
+            return 1;
+        vector<full_move> &turns = full_buffer(level);
+        MoveGen::generate_full(mtx, color, turns);
+        const Position before = mtx;
+        uint64_t nodes = 0;
+        for (const auto &turn : turns)
+        {
+            const uint32_t beaten_kings = MoveGen::make_full(mtx, turn);
+            nodes += count_full_rec(mtx, !color, depth - 1, level + 1);
+            MoveGen::unmake_full(mtx, turn, beaten_kings);
+            check_restored(mtx, before);
+        }
+        return nodes;
+    }
+
+    // Проверка отката: при ошибке позиция восстанавливается, чтобы подсчет продолжился
+    void check_restored(Position &mtx, const Position &before)
+    {
+        if (mtx == before)
+            return;
+        ++unmake_errors;
+        mtx = before;
+    }
+
+    // Продолжение серии взятий фигурой на клетке (x, y)
+    uint64_t series_rec(const Position &mtx, const bool color, const POS_T x, const POS_T y, const int depth,
+                        const size_t level)
+    {
+        vector<move_pos> &turns = buffer(level);
+        if (!MoveGen::generate(mtx, color, uint32_t(1) << Position::square(x, y), turns))
+            return count_rec(mtx, !color, depth - 1, level); // Серия закончилась, ход переходит к противнику
+        uint64_t nodes = 0;
+        for (const auto &turn : turns)
+        {
+            Position next = mtx;
+            MoveGen::make_turn(next, turn);
+            nodes += series_rec(next, color, turn.x2, turn.y2, depth, level + 1);
+        }
+        return nodes;
+    }
+
+    // Перебор серий корневого хода (x == -1 - начало хода) с подсчетом листьев для каждой серии
+    void divide_rec(const Position &mtx, const bool color, const POS_T x, const POS_T y, const int depth,
+                    const size_t level, vector<move_pos> &series,
+                    const function<void(const vector<move_pos> &, uint64_t)> &callback)
+    {
+        vector<move_pos> turns;
+        const bool have_beats =
+            MoveGen::generate(mtx, color, x == -1 ? ~uint32_t(0) : uint32_t(1) << Position::square(x, y), turns);
+        if (x != -1 && !have_beats)
+        {
+            callback(series, count_rec(mtx, !color, depth - 1, level));
+            return;
+        }
+        for (const auto &turn : turns)
+        {
+            Position next = mtx;
+            MoveGen::make_turn(next, turn);
+            series.push_back(turn);
+            if (have_beats)
+                divide_rec(next, color, turn.x2, turn.y2, depth, level + 1, series, callback);
+            else
+                callback(series, count_rec(next, !color, depth - 1, level + 1));
+            series.pop_back();
+        }
+    }
+
+    deque<vector<move_pos>> buffers; // Буферы ходов по уровням рекурсии (deque не перемещает буферы при росте)
+    deque<vector<full_move>> full_buffers; // Буферы полных ходов по уровням рекурсии
+};
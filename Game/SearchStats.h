@@ -0,0 +1,170 @@
+#pragma once
+#include <stdint.h>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#include "Config.h"
+
+using namespace std;
+
+// Статистика поиска включается флагом компиляции SEARCH_STATS
+// Без него все методы счетчиков пустые, и в поиске от них не остается ни одной инструкции
+#ifdef SEARCH_STATS
+const bool SEARCH_STATS_ENABLED = true;
+#else
+const bool SEARCH_STATS_ENABLED = false;
+#endif
+
+// Итоги одной глубины итеративного углубления
+struct depth_stats
+{
+    int depth = 0;      // Глубина (Max_depth)
+    uint64_t nodes = 0; // Узлы этой итерации (основной поиск и поиск взятий за горизонтом)
+    double ms = 0;      // Время итерации
+    double score = 0;   // Оценка лучшего хода
+};
+
+// Счетчики поиска основного потока за один ход бота (вспомогательные потоки считают свое и не учитываются)
+class SearchStats
+{
+  public:
+    static const int CUTOFF_SLOTS = 8; // Номера ходов, давших отсечение: 0..6 отдельно, 7 и дальше вместе
+
+    static constexpr bool enabled()
+    {
+        return SEARCH_STATS_ENABLED;
+    }
+
+    // Начало поиска хода
+    void reset()
+    {
+        if constexpr (SEARCH_STATS_ENABLED)
+        {
+            *this = SearchStats();
+            start = iteration_start = chrono::steady_clock::now();
+        }
+    }
+
+    // Узел основного поиска
+    void node()
+    {
+        if constexpr (SEARCH_STATS_ENABLED)
+            ++nodes;
+    }
+
+    // Узел поиска взятий за горизонтом
+    void quiescence_node()
+    {
+        if constexpr (SEARCH_STATS_ENABLED)
+            ++qnodes;
+    }
+
+    // Оценка спокойной позиции
+    void eval()
+    {
+        if constexpr (SEARCH_STATS_ENABLED)
+            ++evals;
+    }
+
+    // Отсечение по записи таблицы транспозиций
+    void tt_cutoff()
+    {
+        if constexpr (SEARCH_STATS_ENABLED)
+            ++tt_cutoffs;
+    }
+
+    // Отсечение по окну ходом с номером index в порядке перебора
+    void cutoff(const size_t index)
+    {
+        if constexpr (SEARCH_STATS_ENABLED)
+        {
+            ++cutoffs;
+            ++cutoff_at[min(index, size_t(CUTOFF_SLOTS - 1))];
+        }
+    }
+
+    // O2: ход найден с сокращением глубины / перепроверен на полной глубине / узел отсечен ProbCut
+    void reduction()
+    {
+        if constexpr (SEARCH_STATS_ENABLED)
+            ++reductions;
+    }
+
+    void research()
+    {
+        if constexpr (SEARCH_STATS_ENABLED)
+            ++researches;
+    }
+
+    void probcut()
+    {
+        if constexpr (SEARCH_STATS_ENABLED)
+            ++probcuts;
+    }
+
+    // Завершение итерации на глубине depth с оценкой score
+    void iteration(const int depth, const double score)
+    {
+        if constexpr (SEARCH_STATS_ENABLED)
+        {
+            const auto now = chrono::steady_clock::now();
+            depth_stats d;
+            d.depth = depth;
+            d.nodes = nodes + qnodes - counted;
+            d.ms = chrono::duration<double, milli>(now - iteration_start).count();
+            d.score = score;
+            depths.push_back(d);
+            counted = nodes + qnodes;
+            iteration_start = now;
+        }
+    }
+
+    // Эффективный коэффициент ветвления: отношение узлов двух последних итераций,
+    // а при одной итерации - корень степени глубины из числа ее узлов
+    double branching_factor() const
+    {
+        if (depths.size() >= 2 && depths[depths.size() - 2].nodes)
+            return double(depths.back().nodes) / double(depths[depths.size() - 2].nodes);
+        if (depths.size() == 1 && depths[0].depth > 0)
+            return pow(double(depths[0].nodes), 1.0 / (depths[0].depth + 1));
+        return 0;
+    }
+
+    // Запись для журнала: одна строка JSON на ход
+    json to_json() const
+    {
+        json res;
+        res["nodes"] = nodes;
+        res["qnodes"] = qnodes;
+        res["evals"] = evals;
+        res["cutoffs"] = cutoffs;
+        res["cutoff_at"] = vector<uint64_t>(cutoff_at, cutoff_at + CUTOFF_SLOTS);
+        res["first_move_cutoff_rate"] = cutoffs ? double(cutoff_at[0]) / double(cutoffs) : 0.0;
+        res["tt_cutoffs"] = tt_cutoffs;
+        res["reductions"] = reductions;
+        res["researches"] = researches;
+        res["probcuts"] = probcuts;
+        res["ebf"] = branching_factor();
+        res["ms"] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        res["depths"] = json::array();
+        for (const auto &d : depths)
+            res["depths"].push_back({{"depth", d.depth}, {"nodes", d.nodes}, {"ms", d.ms}, {"score", d.score}});
+        return res;
+    }
+
+    uint64_t nodes = 0;                      // Узлы основного поиска
+    uint64_t qnodes = 0;                     // Узлы поиска взятий за горизонтом
+    uint64_t evals = 0;                      // Оценки спокойных позиций
+    uint64_t cutoffs = 0;                    // Отсечения по окну
+    uint64_t cutoff_at[CUTOFF_SLOTS] = {};   // Отсечения по номеру хода, который их дал
+    uint64_t tt_cutoffs = 0;                 // Отсечения по таблице транспозиций
+    uint64_t reductions = 0;                 // O2: ходы, найденные с сокращением глубины
+    uint64_t researches = 0;                 // O2: из них перепроверенные на полной глубине
+    uint64_t probcuts = 0;                   // O2: узлы, отсеченные ProbCut
+    vector<depth_stats> depths;              // Итоги завершенных итераций
+
+  private:
+    uint64_t counted = 0; // Узлы, уже отнесенные к прошлым итерациям
+    chrono::steady_clock::time_point start, iteration_start;
+};
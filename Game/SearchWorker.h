@@ -0,0 +1,126 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../Models/Move.h"
+#include "../Models/Position.h"
+#include "Logic.h"
+
+using namespace std;
+
+// Постоянный поток для поиска хода бота, чтобы окно не замирало на время поиска
+// Поток создается один раз и ждет заданий; задание можно отменить в любой момент
+class SearchWorker
+{
+  public:
+    SearchWorker() : worker(&SearchWorker::run, this)
+    {
+    }
+    SearchWorker(const SearchWorker &) = delete;
+    SearchWorker &operator=(const SearchWorker &) = delete;
+    ~SearchWorker()
+    {
+        {
+            lock_guard<mutex> lock(m);
+            quit = true;
+            cancel_flag = true;
+        }
+        cv.notify_all();
+        worker.join();
+    }
+
+    // Запуск поиска хода цвета color на позиции mtx с логикой logic
+    // Результат готов не раньше чем через min_ms после запуска (задержка хода бота),
+    // после этого вызывается on_done (из потока поиска)
+    void start(Logic *logic, const Position &mtx, const bool color, const int min_ms, function<void()> on_done)
+    {
+        {
+            lock_guard<mutex> lock(m);
+            job = {logic, mtx, color, min_ms, move(on_done)};
+            has_job = true;
+            done = false;
+            cancel_flag = false;
+        }
+        cv.notify_all();
+    }
+
+    // Готов ли результат последнего задания
+    bool ready() const
+    {
+        return done.load();
+    }
+
+    vector<move_pos> result()
+    {
+        lock_guard<mutex> lock(m);
+        return res;
+    }
+
+    // Отмена задания: поиск прерывается, метод возвращается, когда логика задания больше не используется
+    void cancel()
+    {
+        unique_lock<mutex> lock(m);
+        has_job = false;
+        cancel_flag = true;
+        cv.notify_all();
+        cv.wait(lock, [&] { return !busy; });
+    }
+
+  private:
+    struct search_job
+    {
+        Logic *logic = nullptr;
+        Position mtx;
+        bool color = false;
+        int min_ms = 0;
+        function<void()> on_done;
+    };
+
+    void run()
+    {
+        unique_lock<mutex> lock(m);
+        while (true)
+        {
+            cv.wait(lock, [&] { return quit || has_job; });
+            if (quit)
+                return;
+            has_job = false;
+            busy = true;
+            const search_job current = job;
+            lock.unlock();
+
+            const auto start = chrono::steady_clock::now();
+            vector<move_pos> turns = current.logic->find_best_turns(current.mtx, current.color, &cancel_flag);
+
+            lock.lock();
+            // Задержка хода бота: ждем остаток времени, но просыпаемся сразу при отмене
+            cv.wait_until(lock, start + chrono::milliseconds(current.min_ms), [&] { return cancel_flag.load(); });
+            busy = false;
+            const bool cancelled = cancel_flag;
+            if (!cancelled)
+            {
+                res = move(turns);
+                done = true;
+            }
+            cv.notify_all();
+            if (!cancelled && current.on_done)
+                current.on_done();
+        }
+    }
+
+    mutex m;
+    condition_variable cv;
+    search_job job;                  // Задание, ожидающее запуска
+    vector<move_pos> res;            // Результат последнего завершенного задания
+    atomic<bool> cancel_flag{false}; // Сигнал отмены, его же проверяет поиск
+    atomic<bool> done{false};        // Результат готов
+    bool has_job = false;
+    bool busy = false;               // Поток выполняет задание
+    bool quit = false;
+    thread worker;                   // Объявлен последним: запускается, когда остальные поля уже созданы
+};
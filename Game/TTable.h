@@ -0,0 +1,182 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+
+#include "../Models/Position.h"
+
+using namespace std;
+
+// Ключи Зобриста: по одному на каждый тип фигуры на каждой игровой клетке и на очередь хода
+// Тип фигуры: 0 - белая, 1 - черная, 2 - белая дамка, 3 - черная дамка (код Position::get минус 1)
+struct ZobristKeys
+{
+    uint64_t piece[4][32];
+    uint64_t side;        // Ход черных
+    uint64_t perspective; // Оценки посчитаны с точки зрения черного бота
+};
+
+// Генератор псевдослучайных чисел splitmix64, пригодный для вычисления на этапе компиляции
+constexpr uint64_t splitmix64(uint64_t &state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+constexpr ZobristKeys make_zobrist_keys()
+{
+    ZobristKeys keys{};
+    uint64_t state = 0x436865636B657273ull;
+    for (int t = 0; t < 4; ++t)
+        for (int s = 0; s < 32; ++s)
+            keys.piece[t][s] = splitmix64(state);
+    keys.side = splitmix64(state);
+    keys.perspective = splitmix64(state);
+    return keys;
+}
+
+inline constexpr ZobristKeys ZOBRIST = make_zobrist_keys();
+
+// Полный ключ позиции без учета очереди хода
+inline uint64_t zobrist_hash(const Position &mtx)
+{
+    uint64_t key = 0;
+    for (uint32_t m = mtx.white | mtx.black; m; m &= m - 1)
+    {
+        const int s = lsb_index(m);
+        const uint32_t bit = uint32_t(1) << s;
+        key ^= ZOBRIST.piece[((mtx.black & bit) ? 1 : 0) + ((mtx.kings & bit) ? 2 : 0)][s];
+    }
+    return key;
+}
+
+// Тип оценки, сохраненной в таблице
+enum class Bound : uint8_t
+{
+    NONE,  // Пустая запись
+    EXACT, // Точная оценка
+    LOWER, // Оценка снизу (произошло отсечение по beta)
+    UPPER  // Оценка сверху (ни один ход не улучшил alpha)
+};
+
+// Запись таблицы транспозиций в распакованном виде
+struct tt_entry
+{
+    int32_t score = 0;      // Оценка позиции с точки зрения ходящего
+    int8_t from = -1;       // Клетка начала лучшего хода (номер бита) или -1
+    int8_t to = -1;         // Клетка конца лучшего хода
+    int8_t depth = -1;      // Оставшаяся глубина, на которой получена оценка
+    Bound bound = Bound::NONE;
+    uint8_t generation = 0; // Номер поиска, в котором сделана запись
+};
+
+// Ячейка таблицы (24 байта): оценка, упакованные поля записи и ключ, сложенный с ними по XOR
+// Потоки пишут и читают ячейки без блокировок; запись, разорванная параллельной записью, не пройдет проверку ключа
+struct tt_slot
+{
+    atomic<uint64_t> check{0};
+    atomic<uint64_t> score{0};
+    atomic<uint64_t> meta{0};
+};
+
+// Таблица транспозиций фиксированного размера, общая для всех потоков поиска
+class TTable
+{
+  public:
+    TTable() = default;
+    explicit TTable(const size_t size_mb)
+    {
+        resize(size_mb);
+    }
+
+    // Выделение таблицы размером не больше size_mb мегабайт (число записей - степень двойки)
+    void resize(const size_t size_mb)
+    {
+        size_t count = 1;
+        while (count * 2 * sizeof(tt_slot) <= size_mb * 1024 * 1024)
+            count *= 2;
+        size = size_mb ? count : 0;
+        table.reset(size ? new tt_slot[size] : nullptr);
+        mask = size ? size - 1 : 0;
+    }
+
+    // Очистка таблицы
+    void clear()
+    {
+        for (size_t i = 0; i < size; ++i)
+        {
+            table[i].check.store(0, memory_order_relaxed);
+            table[i].score.store(0, memory_order_relaxed);
+            table[i].meta.store(0, memory_order_relaxed);
+        }
+    }
+
+    // Начало нового поиска: старые записи становятся кандидатами на замену
+    // Вызывается до запуска потоков поиска
+    void new_search()
+    {
+        ++generation;
+    }
+
+    // Поиск записи по ключу, false если записи нет
+    bool probe(const uint64_t key, tt_entry &entry) const
+    {
+        if (!size)
+            return false;
+        const tt_slot &slot = table[key & mask];
+        const uint64_t score = slot.score.load(memory_order_relaxed);
+        const uint64_t meta = slot.meta.load(memory_order_relaxed);
+        if ((slot.check.load(memory_order_relaxed) ^ score ^ meta) != key)
+            return false;
+        entry = unpack(meta);
+        entry.score = int32_t(uint32_t(score));
+        return entry.bound != Bound::NONE;
+    }
+
+    // Сохранение записи: глубокие записи текущего поиска не затираются более мелкими
+    void store(const uint64_t key, const int depth, const Bound bound, const int32_t score, const int from,
+               const int to)
+    {
+        if (!size)
+            return;
+        tt_slot &slot = table[key & mask];
+        const uint64_t old_score = slot.score.load(memory_order_relaxed);
+        const uint64_t old_meta = slot.meta.load(memory_order_relaxed);
+        if ((slot.check.load(memory_order_relaxed) ^ old_score ^ old_meta) == key)
+        {
+            const tt_entry old = unpack(old_meta);
+            if (old.generation == generation && old.depth > depth)
+                return;
+        }
+        const uint64_t score_bits = uint32_t(score);
+        const uint64_t meta = uint64_t(uint8_t(from)) | uint64_t(uint8_t(to)) << 8 | uint64_t(uint8_t(depth)) << 16 |
+                              uint64_t(bound) << 24 | uint64_t(generation) << 32;
+        slot.check.store(key ^ score_bits ^ meta, memory_order_relaxed);
+        slot.score.store(score_bits, memory_order_relaxed);
+        slot.meta.store(meta, memory_order_relaxed);
+    }
+
+    bool enabled() const
+    {
+        return size != 0;
+    }
+
+  private:
+    static tt_entry unpack(const uint64_t meta)
+    {
+        tt_entry entry;
+        entry.from = int8_t(meta & 0xFF);
+        entry.to = int8_t(meta >> 8 & 0xFF);
+        entry.depth = int8_t(meta >> 16 & 0xFF);
+        entry.bound = Bound(meta >> 24 & 0xFF);
+        entry.generation = uint8_t(meta >> 32 & 0xFF);
+        return entry;
+    }
+
+    unique_ptr<tt_slot[]> table;
+    size_t size = 0;
+    size_t mask = 0;
+    uint8_t generation = 0;
+};
@@ -0,0 +1,250 @@
+#pragma once
+#include <stdint.h>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "../Models/Position.h"
+#include "MappedFile.h"
+
+using namespace std;
+
+// Эндшпильные таблицы: для каждой позиции с небольшим числом фигур записан точный результат и расстояние до конца
+// Одна таблица на соотношение сил (материал), хранятся только позиции с ходом белых: позиция с ходом черных
+// сводится к ним поворотом доски на 180 градусов со сменой цвета фигур (номер клетки s переходит в 31 - s)
+// Байт записи: 0 - ничья (или позиция невозможна), иначе d + 1, где d - число ходов до конца партии
+// (серия взятий - один ход), при четном d ходящий проигрывает, при нечетном выигрывает.
+// d не больше TB_MAX_DISTANCE, более долгие выигрыш и проигрыш записываются кодами TB_BEYOND_WIN и TB_BEYOND_LOSS
+// (их четность та же, что у обычных кодов), и результат таких позиций таблицы не сообщают
+const int TB_MAX_DISTANCE = 252;
+const uint8_t TB_BEYOND_WIN = 254, TB_BEYOND_LOSS = 255;
+
+// Биномиальные коэффициенты C(n, k) для n <= 32, k <= 8
+struct Binomials
+{
+    uint32_t c[33][9];
+};
+
+constexpr Binomials make_binomials()
+{
+    Binomials b{};
+    for (int n = 0; n <= 32; ++n)
+    {
+        b.c[n][0] = 1;
+        for (int k = 1; k <= 8; ++k)
+            b.c[n][k] = n ? b.c[n - 1][k - 1] + b.c[n - 1][k] : 0;
+    }
+    return b;
+}
+
+inline constexpr Binomials BINOMIALS = make_binomials();
+
+// Поворот позиции на 180 градусов со сменой цвета: позиция с ходом черных становится позицией с ходом белых
+inline uint32_t reverse_bits(uint32_t m)
+{
+    m = ((m >> 1) & 0x55555555u) | ((m & 0x55555555u) << 1);
+    m = ((m >> 2) & 0x33333333u) | ((m & 0x33333333u) << 2);
+    m = ((m >> 4) & 0x0F0F0F0Fu) | ((m & 0x0F0F0F0Fu) << 4);
+    m = ((m >> 8) & 0x00FF00FFu) | ((m & 0x00FF00FFu) << 8);
+    return (m >> 16) | (m << 16);
+}
+
+inline Position flip_position(const Position &mtx)
+{
+    Position res;
+    res.white = reverse_bits(mtx.black);
+    res.black = reverse_bits(mtx.white);
+    res.kings = reverse_bits(mtx.kings);
+    return res;
+}
+
+// Белые простые стоят на клетках 4..31 (на строке 0 они уже дамки), черные простые на клетках 0..27
+const uint32_t TB_WHITE_MEN_SQUARES = 0xFFFFFFF0u, TB_BLACK_MEN_SQUARES = 0x0FFFFFFFu;
+
+// Материал позиции с ходом белых
+struct tb_material
+{
+    int wm = 0, wk = 0, bm = 0, bk = 0; // Простые и дамки белых, простые и дамки черных
+
+    static tb_material of(const Position &mtx)
+    {
+        tb_material m;
+        m.wm = popcount32(mtx.white & ~mtx.kings);
+        m.wk = popcount32(mtx.white & mtx.kings);
+        m.bm = popcount32(mtx.black & ~mtx.kings);
+        m.bk = popcount32(mtx.black & mtx.kings);
+        return m;
+    }
+
+    int pieces() const
+    {
+        return wm + wk + bm + bk;
+    }
+
+    // Материал после смены цвета
+    tb_material flipped() const
+    {
+        return {bm, bk, wm, wk};
+    }
+
+    // Число записей: простые белых и черных нумеруются независимо (пересечения - невозможные позиции),
+    // дамки - среди клеток, свободных от уже расставленных фигур
+    uint64_t size() const
+    {
+        return uint64_t(BINOMIALS.c[28][wm]) * BINOMIALS.c[28][bm] * BINOMIALS.c[32 - wm - bm][wk] *
+               BINOMIALS.c[32 - wm - bm - wk][bk];
+    }
+
+    // Имя файла таблицы, например "2110.tb"
+    string file_name() const
+    {
+        return to_string(wm) + to_string(wk) + to_string(bm) + to_string(bk) + ".tb";
+    }
+
+    int key() const
+    {
+        return ((wm * 16 + wk) * 16 + bm) * 16 + bk;
+    }
+
+    bool operator<(const tb_material &other) const
+    {
+        return key() < other.key();
+    }
+    bool operator==(const tb_material &other) const
+    {
+        return key() == other.key();
+    }
+};
+
+// Номер сочетания клеток из маски среди клеток allowed (комбинаторная система счисления)
+inline uint64_t tb_rank(uint32_t mask, const uint32_t allowed)
+{
+    uint64_t rank = 0;
+    for (int i = 1; mask; mask &= mask - 1, ++i)
+        rank += BINOMIALS.c[popcount32(allowed & ((uint32_t(1) << lsb_index(mask)) - 1))][i];
+    return rank;
+}
+
+// Обратное к tb_rank: маска из k клеток среди клеток allowed
+inline uint32_t tb_unrank(uint64_t rank, const int k, const uint32_t allowed)
+{
+    uint32_t mask = 0;
+    int n = popcount32(allowed);
+    for (int i = k; i > 0; --i)
+    {
+        while (BINOMIALS.c[n][i] > rank)
+            --n;
+        rank -= BINOMIALS.c[n][i];
+        uint32_t rest = allowed; // Клетка с номером n среди разрешенных
+        for (int j = 0; j < n; ++j)
+            rest &= rest - 1;
+        mask |= rest & (0 - rest);
+    }
+    return mask;
+}
+
+// Номер позиции с ходом белых в таблице ее материала
+inline uint64_t tb_index(const Position &mtx, const tb_material &m)
+{
+    const uint32_t white_men = mtx.white & ~mtx.kings, black_men = mtx.black & ~mtx.kings;
+    const uint32_t free_squares = ~(white_men | black_men);
+    uint64_t index = tb_rank(white_men, TB_WHITE_MEN_SQUARES);
+    index = index * BINOMIALS.c[28][m.bm] + tb_rank(black_men, TB_BLACK_MEN_SQUARES);
+    index = index * BINOMIALS.c[32 - m.wm - m.bm][m.wk] + tb_rank(mtx.white & mtx.kings, free_squares);
+    index = index * BINOMIALS.c[32 - m.wm - m.bm - m.wk][m.bk] +
+            tb_rank(mtx.black & mtx.kings, free_squares & ~(mtx.white & mtx.kings));
+    return index;
+}
+
+// Позиция по номеру в таблице материала m, false для невозможной позиции (простые фигуры на одной клетке)
+inline bool tb_position(uint64_t index, const tb_material &m, Position &mtx)
+{
+    const uint64_t n_bk = BINOMIALS.c[32 - m.wm - m.bm - m.wk][m.bk], n_wk = BINOMIALS.c[32 - m.wm - m.bm][m.wk];
+    const uint64_t r_bk = index % n_bk;
+    index /= n_bk;
+    const uint64_t r_wk = index % n_wk;
+    index /= n_wk;
+    const uint64_t r_bm = index % BINOMIALS.c[28][m.bm];
+    const uint64_t r_wm = index / BINOMIALS.c[28][m.bm];
+    const uint32_t white_men = tb_unrank(r_wm, m.wm, TB_WHITE_MEN_SQUARES);
+    const uint32_t black_men = tb_unrank(r_bm, m.bm, TB_BLACK_MEN_SQUARES);
+    if (white_men & black_men)
+        return false;
+    const uint32_t white_kings = tb_unrank(r_wk, m.wk, ~(white_men | black_men));
+    const uint32_t black_kings = tb_unrank(r_bk, m.bk, ~(white_men | black_men | white_kings));
+    mtx.white = white_men | white_kings;
+    mtx.black = black_men | black_kings;
+    mtx.kings = white_kings | black_kings;
+    return true;
+}
+
+// Результат позиции для ходящей стороны
+enum class TBResult
+{
+    UNKNOWN, // Позиции нет в таблицах
+    DRAW,
+    WIN,
+    LOSS
+};
+
+// Набор эндшпильных таблиц, отображенных в память, общий для всех копий логики
+class Tablebase
+{
+  public:
+    // Загрузка всех таблиц до max_pieces фигур из папки path, отсутствующие таблицы пропускаются
+    Tablebase(const string &path, const int max_pieces)
+    {
+        for_each_material(max_pieces, [&](const tb_material &m) {
+            auto file = make_unique<MappedFile>(path + m.file_name());
+            if (file->data && file->size == m.size())
+            {
+                pieces = max(pieces, m.pieces());
+                tables[m] = move(file);
+            }
+        });
+    }
+
+    // Перебор всех материалов до max_pieces фигур, у каждой стороны хотя бы одна фигура
+    template <class F> static void for_each_material(const int max_pieces, F callback)
+    {
+        for (int wm = 0; wm <= max_pieces; ++wm)
+            for (int wk = 0; wm + wk <= max_pieces; ++wk)
+                for (int bm = 0; wm + wk + bm <= max_pieces; ++bm)
+                    for (int bk = 0; wm + wk + bm + bk <= max_pieces; ++bk)
+                        if (wm + wk && bm + bk)
+                            callback(tb_material{wm, wk, bm, bk});
+    }
+
+    // Результат позиции с ходом color и расстояние до конца партии в ходах
+    TBResult probe(const Position &mtx, const bool color, int &distance) const
+    {
+        if (popcount32(mtx.occupied()) > pieces)
+            return TBResult::UNKNOWN;
+        const Position pos = color ? flip_position(mtx) : mtx;
+        // В таблицах нет простых фигур на последней для них горизонтали, номер такой позиции вышел бы за таблицу
+        if ((pos.white & ~pos.kings & ~TB_WHITE_MEN_SQUARES) || (pos.black & ~pos.kings & ~TB_BLACK_MEN_SQUARES))
+            return TBResult::UNKNOWN;
+        const tb_material m = tb_material::of(pos);
+        const auto it = tables.find(m);
+        if (it == tables.end())
+            return TBResult::UNKNOWN;
+        const uint8_t code = it->second->data[tb_index(pos, m)];
+        if (!code)
+            return TBResult::DRAW;
+        if (code >= TB_BEYOND_WIN) // Расстояние не поместилось в запись, позицию нужно искать
+            return TBResult::UNKNOWN;
+        distance = code - 1;
+        return distance % 2 ? TBResult::WIN : TBResult::LOSS;
+    }
+
+    // Наибольшее число фигур в загруженных таблицах (0 - таблиц нет)
+    int max_pieces() const
+    {
+        return pieces;
+    }
+
+  private:
+    map<tb_material, unique_ptr<MappedFile>> tables;
+    int pieces = 0;
+};
@@ -0,0 +1,220 @@
+#pragma once
+#include <stdint.h>
+#include <algorithm>
+#include <climits>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../Models/Move.h"
+#include "../Models/Position.h"
+#include "MoveGen.h"
+#include "Tablebase.h"
+
+using namespace std;
+
+// Построение эндшпильных таблиц ретроградным анализом
+// Таблицы строятся от меньшего числа фигур к большему, а при равном числе фигур - от меньшего числа простых,
+// поэтому взятия и превращения ведут в уже готовые таблицы. Материал и его цветовое отражение решаются вместе:
+// тихие ходы переводят позицию одного из них в позицию другого.
+// Позиции решаются в порядке возрастания расстояния: решенная позиция через обратные ходы сообщает результат
+// предшественникам. Предшественник проигранной позиции выигрывает, а предшественник, у которого все ходы
+// ведут в выигрыш противника, проигрывает за самый долгий из них.
+// Расстояние хранится в байте и не больше TB_MAX_DISTANCE: анализ продолжается и дальше, но позиции с более
+// долгим выигрышем или проигрышем получают коды TB_BEYOND_WIN и TB_BEYOND_LOSS. Для анализа эти коды - выигрыш
+// и проигрыш длиннее любого записанного, а Tablebase::probe для них отвечает UNKNOWN
+class TablebaseGen
+{
+  public:
+    // Построение всех таблиц до max_pieces фигур в папку path, log получает имя и статистику каждой таблицы
+    // (capped - число позиций с расстоянием больше TB_MAX_DISTANCE)
+    template <class Log> void build(const int max_pieces, const string &path, Log log)
+    {
+        vector<tb_material> order;
+        Tablebase::for_each_material(max_pieces, [&](const tb_material &m) { order.push_back(m); });
+        stable_sort(order.begin(), order.end(), [](const tb_material &a, const tb_material &b) {
+            return make_pair(a.pieces(), a.wm + a.bm) < make_pair(b.pieces(), b.wm + b.bm);
+        });
+        for (const auto &m : order)
+        {
+            if (tables.count(m))
+                continue;
+            vector<tb_material> group = {m}; // Материал и его цветовое отражение
+            if (!(m.flipped() == m))
+                group.push_back(m.flipped());
+            solve(group);
+            for (const auto &g : group)
+            {
+                const vector<uint8_t> &data = tables[g];
+                ofstream fout(path + g.file_name(), ios::binary | ios::trunc);
+                fout.write(reinterpret_cast<const char *>(data.data()), streamsize(data.size()));
+                uint64_t wins = 0, losses = 0, capped = 0;
+                int longest = 0;
+                for (const uint8_t code : data)
+                {
+                    if (code >= TB_BEYOND_WIN)
+                        ++capped;
+                    else if (code)
+                    {
+                        ++((code - 1) % 2 ? wins : losses);
+                        longest = max(longest, code - 1);
+                    }
+                }
+                log(g.file_name(), data.size(), wins, losses, longest, capped);
+            }
+        }
+    }
+
+  private:
+
+    // Решение группы материалов, у которых тихие ходы ведут друг в друга
+    void solve(const vector<tb_material> &group)
+    {
+        // Для каждой позиции: число ходов внутри группы, еще не ведущих в выигрыш противника,
+        // самый долгий выигрыш противника среди решенных ходов и признак хода не в выигрыш противника
+        // (в ничью или в проигрыш), при котором позиция не может быть проиграна
+        vector<vector<uint8_t>> open(group.size());
+        vector<vector<uint16_t>> longest_win(group.size());
+        vector<vector<bool>> cannot_lose(group.size());
+        for (size_t g = 0; g < group.size(); ++g)
+        {
+            tables[group[g]].assign(group[g].size(), 0);
+            open[g].assign(group[g].size(), 0);
+            longest_win[g].assign(group[g].size(), 0);
+            cannot_lose[g].assign(group[g].size(), false);
+        }
+        vector<vector<pair<uint8_t, uint64_t>>> queue(TB_MAX_DISTANCE + 1); // Кандидаты по расстоянию
+        auto push = [&](const size_t g, const uint64_t i, const int n) {
+            if (size_t(n) >= queue.size())
+                queue.resize(n + 1);
+            queue[n].emplace_back(uint8_t(g), i);
+        };
+
+        // Прямой проход: ходы, ведущие в другие (уже построенные) таблицы, и число ходов внутри группы
+        vector<Position> next;
+        for (size_t g = 0; g < group.size(); ++g)
+        {
+            for (uint64_t i = 0; i < group[g].size(); ++i)
+            {
+                Position mtx;
+                if (!tb_position(i, group[g], mtx))
+                    continue;
+                next.clear();
+                collect_turns(mtx, next);
+                int win = INT_MAX, loss = 0, inside = 0;
+                for (const auto &pos : next)
+                {
+                    if (!pos.black) // У противника не осталось фигур
+                    {
+                        win = 1;
+                        cannot_lose[g][i] = true;
+                        continue;
+                    }
+                    const Position flipped = flip_position(pos);
+                    const tb_material m = tb_material::of(flipped);
+                    if (find(group.begin(), group.end(), m) != group.end())
+                    {
+                        ++inside;
+                        continue;
+                    }
+                    const uint8_t code = tables.at(m)[tb_index(flipped, m)];
+                    if (!code || (code - 1) % 2 == 0)
+                        cannot_lose[g][i] = true;
+                    if (code && (code - 1) % 2 == 0) // Ход в проигрыш противника
+                        win = min(win, int(code));
+                    else
+                        loss = max(loss, int(code));
+                }
+                open[g][i] = uint8_t(inside);
+                longest_win[g][i] = uint16_t(loss);
+                if (win != INT_MAX)
+                    push(g, i, win);
+                else if (!inside && !cannot_lose[g][i]) // Все ходы ведут в выигрыш противника (или ходов нет)
+                    push(g, i, loss);
+            }
+        }
+
+        // Обратный проход в порядке возрастания расстояния
+        vector<Position> prev;
+        for (int n = 0; size_t(n) < queue.size(); ++n)
+        {
+            for (size_t q = 0; q < queue[n].size(); ++q)
+            {
+                const size_t g = queue[n][q].first;
+                const uint64_t i = queue[n][q].second;
+                if (tables[group[g]][i])
+                    continue;
+                tables[group[g]][i] =
+                    n <= TB_MAX_DISTANCE ? uint8_t(n + 1) : (n % 2 ? TB_BEYOND_WIN : TB_BEYOND_LOSS);
+                Position mtx;
+                tb_position(i, group[g], mtx);
+                prev.clear();
+                collect_predecessors(mtx, prev);
+                for (const auto &pos : prev)
+                {
+                    const tb_material m = tb_material::of(pos);
+                    const size_t pg = find(group.begin(), group.end(), m) - group.begin();
+                    const uint64_t pi = tb_index(pos, m);
+                    if (tables[m][pi])
+                        continue;
+                    if (n % 2 == 0) // Предшественник проигранной позиции выигрывает
+                        push(pg, pi, n + 1);
+                    else
+                    {
+                        longest_win[pg][pi] = uint16_t(max(int(longest_win[pg][pi]), n + 1));
+                        if (--open[pg][pi] == 0 && !cannot_lose[pg][pi])
+                            push(pg, pi, longest_win[pg][pi]);
+                    }
+                }
+            }
+            vector<pair<uint8_t, uint64_t>>().swap(queue[n]);
+        }
+    }
+
+    // Позиции после всех полных ходов белых (серия взятий - один ход)
+    void collect_turns(const Position &mtx, vector<Position> &next)
+    {
+        MoveGen::generate_full(mtx, false, full);
+        for (const auto &turn : full)
+        {
+            Position pos = mtx;
+            MoveGen::make_full(pos, turn);
+            next.push_back(pos);
+        }
+    }
+
+    // Позиции с ходом белых, из которых тихий ход без превращения ведет в позицию mtx с ходом белых
+    // после смены цвета (то есть в позицию flip_position(mtx) с ходом черных)
+    void collect_predecessors(const Position &mtx, vector<Position> &prev)
+    {
+        const Position after = flip_position(mtx); // Позиция сразу после хода белых
+        const uint32_t empty = ~after.occupied();
+        vector<move_pos> turns;
+        for (uint32_t m = after.white; m; m &= m - 1)
+        {
+            const int s = lsb_index(m);
+            const bool is_king = (after.kings >> s) & 1;
+            for (int d = 0; d < 4; ++d)
+            {
+                if (!is_king && d != DIR_DL && d != DIR_DR) // Простая фигура пришла снизу
+                    continue;
+                for (int k = 0; k < RAYS.len[d][s] && (empty >> RAYS.sq[d][s][k] & 1); ++k)
+                {
+                    const uint32_t from = uint32_t(1) << RAYS.sq[d][s][k];
+                    Position pos = after;
+                    pos.white ^= from | (uint32_t(1) << s);
+                    if (is_king)
+                        pos.kings ^= from | (uint32_t(1) << s);
+                    if (!MoveGen::generate(pos, false, ~uint32_t(0), turns)) // При взятии тихий ход невозможен
+                        prev.push_back(pos);
+                    if (!is_king)
+                        break;
+                }
+            }
+        }
+    }
+
+    vector<full_move> full;                   // Буфер полных ходов для collect_turns
+    map<tb_material, vector<uint8_t>> tables; // Построенные таблицы
+};
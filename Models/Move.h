@@ -1,4 +1,5 @@
 #pragma once
+#include <stdint.h>
 #include <stdlib.h>
 
 // Тип для представления позиции на доске (8 бит целое число)
@@ -31,3 +32,28 @@ struct move_pos
         return !(*this == other); // Используем оператор == для определения неравенства
     }
 };
+
+// Сведения для отката хода, выполненного на позиции на месте
+struct move_undo
+{
+    bool beaten_king = false; // Взятая фигура была дамкой
+    bool promoted = false;    // Фигура превратилась в дамку этим ходом
+};
+
+// Полный ход для поиска: тихий ход или вся серия взятий одной фигуры, выполняется на позиции за один шаг
+struct full_move
+{
+    int8_t from = 0;       // Клетка начала хода (номер бита)
+    int8_t to = 0;         // Клетка конца хода (для серии - последняя клетка)
+    bool promotes = false; // Простая фигура становится дамкой (в том числе посреди серии взятий)
+    uint32_t captured = 0; // Взятые фигуры
+
+    bool operator==(const full_move &other) const
+    {
+        return from == other.from && to == other.to && promotes == other.promotes && captured == other.captured;
+    }
+    bool operator!=(const full_move &other) const
+    {
+        return !(*this == other);
+    }
+};
@@ -0,0 +1,85 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "Move.h"
+#include "Position.h"
+
+using namespace std;
+
+// Текстовая запись позиций и ходов для консольной программы
+// Позиция: 8 строк доски сверху вниз через '/', в каждой 8 символов
+// ('.' - пусто, 'w'/'b' - белая/черная фигура, 'W'/'B' - белая/черная дамка), затем через пробел очередь хода 'w' или 'b'
+// Клетка: столбец 'a'-'h' и горизонталь '1'-'8' (белые внизу), ход "c3-d4", серия взятий "c3:e5:c7"
+
+// Начальная расстановка: черные в строках 0-2, белые в строках 5-7
+inline Position start_position()
+{
+    Position mtx;
+    for (POS_T i = 0; i < 8; ++i)
+        for (POS_T j = 0; j < 8; ++j)
+            if ((i + j) % 2 && i != 3 && i != 4)
+                mtx.set(i, j, i < 3 ? 2 : 1);
+    return mtx;
+}
+
+// Название клетки (x - строка, y - столбец)
+inline string square_name(const POS_T x, const POS_T y)
+{
+    return string(1, char('a' + y)) + char('8' - x);
+}
+
+// Запись хода или серии взятий одной фигуры
+inline string turns_to_string(const vector<move_pos> &turns)
+{
+    if (turns.empty())
+        return "";
+    string res = square_name(turns[0].x, turns[0].y);
+    for (const auto &turn : turns)
+        res += (turn.xb != -1 ? ":" : "-") + square_name(turn.x2, turn.y2);
+    return res;
+}
+
+// Запись позиции с очередью хода
+inline string position_to_string(const Position &mtx, const bool color)
+{
+    const char symbols[] = ".wbWB";
+    string res;
+    for (POS_T i = 0; i < 8; ++i)
+    {
+        if (i)
+            res += '/';
+        for (POS_T j = 0; j < 8; ++j)
+            res += symbols[mtx.get(i, j)];
+    }
+    return res + (color ? " b" : " w");
+}
+
+// Разбор позиции, false при ошибке формата, фигуре на неигровой клетке или простой фигуре на последней
+// для нее горизонтали (там она уже стала бы дамкой)
+inline bool parse_position(const string &text, Position &mtx, bool &color)
+{
+    const string symbols = ".wbWB";
+    if (text.size() != 8 * 9 + 1 || text[8 * 9 - 1] != ' ')
+        return false;
+    mtx = Position();
+    for (POS_T i = 0; i < 8; ++i)
+    {
+        if (i && text[i * 9 - 1] != '/')
+            return false;
+        for (POS_T j = 0; j < 8; ++j)
+        {
+            const size_t type = symbols.find(text[i * 9 + j]);
+            if (type == string::npos || (type && (i + j) % 2 == 0))
+                return false;
+            if ((type == 1 && i == 0) || (type == 2 && i == 7))
+                return false;
+            if (type)
+                mtx.set(i, j, POS_T(type));
+        }
+    }
+    if (text.back() != 'w' && text.back() != 'b')
+        return false;
+    color = text.back() == 'b';
+    return true;
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <stdint.h>
+
+#include "Move.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Количество установленных бит в маске
+inline int popcount32(const uint32_t mask)
+{
+#ifdef _MSC_VER
+    return int(__popcnt(mask));
+#else
+    return __builtin_popcount(mask);
+#endif
+}
+
+// Номер младшего установленного бита (маска не должна быть пустой)
+inline int lsb_index(const uint32_t mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return int(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+// Компактное представление позиции на доске (12 байт, POD)
+// Используются только 32 игровые клетки (x + y) % 2 == 1, клетке (x, y) соответствует бит x * 4 + y / 2
+struct Position
+{
+    uint32_t white = 0; // Маска белых фигур (включая дамки)
+    uint32_t black = 0; // Маска черных фигур (включая дамки)
+    uint32_t kings = 0; // Маска дамок обоих цветов
+
+    // Номер бита для игровой клетки (x, y)
+    static constexpr int square(const POS_T x, const POS_T y)
+    {
+        return x * 4 + y / 2;
+    }
+    // Строка клетки по номеру бита
+    static constexpr POS_T square_x(const int s)
+    {
+        return POS_T(s / 4);
+    }
+    // Столбец клетки по номеру бита
+    static constexpr POS_T square_y(const int s)
+    {
+        return POS_T((s % 4) * 2 + 1 - (s / 4) % 2);
+    }
+
+    // Тип фигуры на клетке в прежней кодировке матрицы доски
+    // 0 - пусто, 1 - белая фигура, 2 - черная фигура, 3 - белая дамка, 4 - черная дамка
+    POS_T get(const POS_T x, const POS_T y) const
+    {
+        if ((x + y) % 2 == 0) // Неигровые клетки всегда пустые
+            return 0;
+        const uint32_t bit = uint32_t(1) << square(x, y);
+        if (!((white | black) & bit))
+            return 0;
+        return POS_T(((black & bit) ? 2 : 1) + ((kings & bit) ? 2 : 0));
+    }
+
+    // Установка фигуры заданного типа на клетку (0 - очистка клетки)
+    void set(const POS_T x, const POS_T y, const POS_T type)
+    {
+        const uint32_t bit = uint32_t(1) << square(x, y);
+        white &= ~bit;
+        black &= ~bit;
+        kings &= ~bit;
+        if (type == 0)
+            return;
+        if (type % 2) // Нечетные типы - белые
+            white |= bit;
+        else
+            black |= bit;
+        if (type > 2) // Дамка
+            kings |= bit;
+    }
+
+    // Маска всех фигур заданного цвета (0 - белые, 1 - черные)
+    uint32_t pieces(const bool color) const
+    {
+        return color ? black : white;
+    }
+
+    // Маска занятых клеток
+    uint32_t occupied() const
+    {
+        return white | black;
+    }
+
+    bool operator==(const Position &other) const
+    {
+        return white == other.white && black == other.black && kings == other.kings;
+    }
+    bool operator!=(const Position &other) const
+    {
+        return !(*this == other);
+    }
+};
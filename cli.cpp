@@ -0,0 +1,458 @@
+// Консольная программа без SDL2: партии бота против бота и анализ позиций через stdin/stdout
+// Использование: cli <play|analyze|perft|bench|tbgen|book|embed> [--settings=path] [--games=N] [--depth=N] [--divide]
+//                    [--full] [--pieces=N] [--plies=N] [--Section.Name=value ...]
+//   play    - играет N партий (по умолчанию 1) из начальной позиции, по строке на партию: результат, число ходов, ходы
+//   analyze - читает позиции из stdin (по одной в строке, формат Models/Notation.h) и выводит лучший ход,
+//             его оценку и позицию после хода
+//   perft   - без --depth сверяет число листьев дерева ходов на эталонных позициях с записанными значениями
+//             (по сериям взятий и по полным ходам поиска), с --depth=N считает листья для позиций из stdin
+//             (--divide - отдельно для каждого хода из корня, --full - по полным ходам поиска)
+//   bench   - поиск на эталонных позициях на глубинах 1..N (по умолчанию 11) без случайности в одном потоке,
+//             выводит лучший ход, узлы и время до каждой глубины, в конце скорость и сигнатуру результатов
+//             (собранная с -DSEARCH_STATS выводит и подробную статистику поиска на последней глубине)
+//   tbgen   - строит эндшпильные таблицы до N фигур (по умолчанию 4) в папку Bot.TablebasePath
+//             (выигрыши и проигрыши длиннее 252 полуходов помечаются как не решенные таблицей, бот их ищет)
+//   book    - строит дебютную книгу Bot.BookPath из N партий бота с самим собой по первым --plies ходам (по умолчанию 12)
+//   embed   - записывает картинки из папки Textures в Textures/embedded_textures.h для сборки с флагом EMBED_TEXTURES
+// Настройки берутся из settings.json, флаги --Section.Name=value их переопределяют (например --Bot.BotTimeMS=100)
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Game/Config.h"
+#include "Game/Logic.h"
+#include "Game/Perft.h"
+#include "Game/TablebaseGen.h"
+#include "Models/Notation.h"
+
+// Ход бота за цвет color на позиции mtx, позиция изменяется на месте
+vector<move_pos> bot_turn(Config &config, Logic &logic, Position &mtx, const bool color)
+{
+    logic.Max_depth = config("Bot", string(color ? "Black" : "White") + string("BotLevel")); // Глубина поиска для цвета
+    auto turns = logic.find_best_turns(mtx, color);
+    for (const auto &turn : turns)
+        MoveGen::make_turn(mtx, turn);
+    return turns;
+}
+
+// Партия бота против бота, возвращает результат как Game::play: 0 - ничья, 1 - победа белых, 2 - победа черных
+// on_turn(номер хода, позиция до хода, серия) вызывается после каждого хода
+template <class F> int play_game(Config &config, Logic &logic, int &turn_num, F on_turn)
+{
+    Position mtx = start_position();
+    const int Max_turns = config("Game", "MaxNumTurns");
+    turn_num = -1;
+    while (++turn_num < Max_turns)
+    {
+        logic.find_turns(turn_num % 2, mtx);
+        if (logic.turns.empty()) // Нет ходов - поражение ходящего
+            return turn_num % 2 ? 1 : 2;
+        const Position before = mtx;
+        on_turn(turn_num, before, bot_turn(config, logic, mtx, turn_num % 2));
+    }
+    return 0;
+}
+
+int play(Config &config, const int games)
+{
+    const string results[] = {"draw", "white", "black"};
+    int total[3] = {};
+    Logic logic(&config); // Одна логика на все партии, чтобы партии отличались при NoRandom = false
+    for (int i = 0; i < games; ++i)
+    {
+        string record;
+        int turn_num;
+        const int res =
+            play_game(config, logic, turn_num, [&](const int num, const Position &, const vector<move_pos> &turns) {
+                record += (num ? " " : "") + turns_to_string(turns);
+            });
+        ++total[res];
+        cout << results[res] << ' ' << turn_num << ' ' << record << endl;
+    }
+    if (games > 1)
+        cout << "white " << total[1] << " black " << total[2] << " draw " << total[0] << endl;
+    return 0;
+}
+
+// Дебютная книга из партий бота с самим собой: ходы первых plies ходов партии получают вес 2 за победу
+// сделавшей их стороны, 1 за ничью и 0 за поражение
+int build_book(Config &config, const int games, const int plies)
+{
+    const string path = config("Bot", "BookPath");
+    if (path.empty())
+    {
+        cerr << "set the book file with --Bot.BookPath=path" << endl;
+        return 1;
+    }
+    Config play_config = config;
+    play_config.set("Bot", "BookPath", "\"\""); // Партии для книги играются без старой книги
+    play_config.set("Bot", "NoRandom", "false"); // Случайный выбор из равных ходов дает разные дебюты
+    Logic logic(&play_config);
+    BookBuilder builder;
+    for (int i = 0; i < games; ++i)
+    {
+        vector<pair<uint64_t, uint64_t>> moves[2]; // Ходы белых и черных: ключи позиций до и после хода
+        int turn_num;
+        const int res = play_game(play_config, logic, turn_num,
+                                  [&](const int num, const Position &before, const vector<move_pos> &turns) {
+                                      if (num >= plies)
+                                          return;
+                                      Position after = before;
+                                      for (const auto &turn : turns)
+                                          MoveGen::make_turn(after, turn);
+                                      moves[num % 2].emplace_back(book_key(before, num % 2),
+                                                                  book_key(after, !(num % 2)));
+                                  });
+        for (int color = 0; color < 2; ++color)
+            for (const auto &m : moves[color])
+                builder.add(m.first, m.second, res == 0 ? 1 : (res == color + 1 ? 2 : 0));
+        if ((i + 1) % 100 == 0)
+            cerr << i + 1 << " games" << endl;
+    }
+    const long long count = builder.save(path);
+    if (count < 0)
+    {
+        cerr << "can't write " << path << endl;
+        return 1;
+    }
+    cout << "book " << path << " entries " << count << endl;
+    return 0;
+}
+
+int analyze(Config &config)
+{
+    Logic logic(&config);
+    string line;
+    while (getline(cin, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (line.empty())
+            continue;
+        Position mtx;
+        bool color;
+        if (!parse_position(line, mtx, color))
+        {
+            cout << "error: bad position" << endl;
+            continue;
+        }
+        logic.find_turns(color, mtx);
+        if (logic.turns.empty())
+        {
+            cout << "none" << endl;
+            continue;
+        }
+        const auto turns = bot_turn(config, logic, mtx, color);
+        cout << turns_to_string(turns) << ' ' << logic.last_score << ' ' << position_to_string(mtx, !color) << endl;
+    }
+    return 0;
+}
+
+// Эталонные позиции для perft и число листьев на глубинах 1, 2, ...: по сериям взятий (nodes)
+// и по полным ходам поиска, где серии, приводящие к одной позиции, - один ход (full)
+struct perft_reference
+{
+    const char *position;
+    vector<uint64_t> nodes;
+    vector<uint64_t> full;
+};
+
+const perft_reference PERFT_SUITE[] = {
+    // Начальная позиция
+    {".b.b.b.b/b.b.b.b./.b.b.b.b/......../......../w.w.w.w./.w.w.w.w/w.w.w.w. w",
+     {7, 49, 302, 1469, 7482, 37986, 190146, 929984, 4571392},
+     {7, 49, 302, 1469, 7482, 37986, 190146, 929978, 4571311}},
+    // Взятия дамкой: выбор клетки за взятой фигурой и ветвление серии
+    {"...B..../......../.b...b../......../......../..b...../.....w../W....... w",
+     {5, 34, 299, 2008, 16221, 107025, 826969, 5447915},
+     {3, 20, 169, 1132, 8921, 58483, 446907, 2930249}},
+    // Превращение в дамку посреди серии: дальше фигура бьет как дамка
+    {".....b../..b...../...w..../......../.....b../......../......../w....... w",
+     {2, 4, 36, 70, 532, 765, 5159, 8580, 62135},
+     {2, 4, 36, 70, 532, 765, 5159, 8580, 62135}},
+    // Дамки обеих сторон, ход черных
+    {"......../b...W.../.b.w..../..B.b.../.w.w.w../......b./.w...w../........ b",
+     {9, 21, 88, 662, 3649, 22965, 140506, 927495},
+     {9, 21, 88, 662, 3596, 22727, 137451, 909209}},
+    // Дамка бьет две фигуры через разные промежуточные клетки (c1:e3:h6 и c1:f4:h6) - один полный ход
+    {".b.....b/b.b...b./......../w.....w./......../......../...w..../w.B...w. b",
+     {2, 8, 58, 198, 1582, 5532, 45506, 145156},
+     {1, 4, 29, 99, 791, 2766, 22753, 72578}},
+    // Дамка обходит круг в разном порядке взятий (f8:d6:b8:g3 и f8:d6:g3:b8) - один полный ход
+    {"...b.W.b/..b.b.../......../w.b.b.../......../w.w...../.......w/..w.w... w",
+     {5, 26, 171, 702, 4516, 17218, 117735},
+     {4, 21, 135, 561, 3551, 13645, 92043}},
+};
+
+// Вывод числа листьев и скорости для одной позиции
+void print_perft(const uint64_t nodes, const chrono::steady_clock::time_point start)
+{
+    const double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << nodes << " nodes " << (int)ms << " ms " << (uint64_t)(nodes / max(ms, 1e-3) * 1000) << " nps" << endl;
+}
+
+int perft(const int depth, const bool divide, const bool full)
+{
+    Perft perft;
+    if (depth <= 0) // Проверка эталонных значений
+    {
+        bool ok = true;
+        uint64_t total = 0;
+        const auto start = chrono::steady_clock::now();
+        for (const auto &ref : PERFT_SUITE)
+        {
+            Position mtx;
+            bool color;
+            parse_position(ref.position, mtx, color);
+            cout << ref.position << endl;
+            for (size_t d = 1; d <= ref.nodes.size(); ++d)
+            {
+                const uint64_t nodes = perft.count(mtx, color, int(d));
+                const uint64_t full_nodes = perft.count_full(mtx, color, int(d));
+                total += nodes + full_nodes;
+                cout << "  depth " << d << ": " << nodes;
+                if (nodes != ref.nodes[d - 1])
+                {
+                    cout << " expected " << ref.nodes[d - 1] << " FAIL";
+                    ok = false;
+                }
+                cout << ", full moves " << full_nodes;
+                if (full_nodes != ref.full[d - 1])
+                {
+                    cout << " expected " << ref.full[d - 1] << " FAIL";
+                    ok = false;
+                }
+                cout << endl;
+            }
+        }
+        if (perft.unmake_errors)
+        {
+            cout << "unmake_full did not restore the position " << perft.unmake_errors << " times" << endl;
+            ok = false;
+        }
+        print_perft(total, start);
+        cout << (ok ? "perft ok" : "perft FAIL") << endl;
+        return ok ? 0 : 1;
+    }
+
+    string line;
+    while (getline(cin, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (line.empty())
+            continue;
+        Position mtx;
+        bool color;
+        if (!parse_position(line, mtx, color))
+        {
+            cout << "error: bad position" << endl;
+            continue;
+        }
+        const auto start = chrono::steady_clock::now();
+        uint64_t nodes = 0;
+        if (divide && full)
+        {
+            perft.divide_full(mtx, color, depth, [&](const full_move &turn, const uint64_t count) {
+                cout << turns_to_string(MoveGen::series_of(mtx, color, turn)) << ' ' << count << endl;
+                nodes += count;
+            });
+        }
+        else if (divide)
+        {
+            perft.divide(mtx, color, depth, [&](const vector<move_pos> &series, const uint64_t count) {
+                cout << turns_to_string(series) << ' ' << count << endl;
+                nodes += count;
+            });
+        }
+        else
+            nodes = full ? perft.count_full(mtx, color, depth) : perft.count(mtx, color, depth);
+        print_perft(nodes, start);
+    }
+    if (perft.unmake_errors)
+    {
+        cout << "unmake_full did not restore the position " << perft.unmake_errors << " times" << endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Позиции для замера поиска: дебют, миттельшпиль и окончания с дамками
+const char *BENCH_POSITIONS[] = {
+    ".b.b.b.b/b.b.b.b./.b.b.b.b/......../......../w.w.w.w./.w.w.w.w/w.w.w.w. w",
+    ".b.b.b.b/b.b.b.../...b.b.b/....w.../.....w.b/w......./.w.w.w.w/w.w.w.w. w",
+    ".b...b.b/b.b.b.b./.b.....b/......../.......w/..w.b.w./.w.....w/w...w.w. w",
+    ".b...b.b/b.....b./.......b/w......./.....w.b/w.w...../.....w.w/w.w.w.w. b",
+    ".....b../w...b.../.w.b..../......../......../w......./.w....../..w.B... w",
+    ".W.b.b../b.....b./.......b/......../.......w/....w.../...w.w.w/B...w.w. b",
+    "......../......../.....b.b/b......./.....w../..w.w.../...w.w../..B..... w",
+    ".....b.b/b......./......../......../......../..b...../.B.....W/........ b",
+};
+
+int bench(Config &config, const int depth)
+{
+    // Результаты должны воспроизводиться: без случайности, в одном потоке и на фиксированной глубине
+    config.set("Bot", "NoRandom", "true");
+    config.set("Bot", "BotThreads", "1");
+    config.set("Bot", "BotTimeMS", "0");
+    config.set("Bot", "BookPath", "\"\""); // Книжные ходы не ищутся, замер был бы бессмысленным
+    uint64_t total = 0, signature = 14695981039346656037ull; // Сигнатура - FNV-1a от узлов и лучших ходов
+    double total_ms = 0;
+    for (const char *text : BENCH_POSITIONS)
+    {
+        Position mtx;
+        bool color;
+        parse_position(text, mtx, color);
+        cout << text << endl;
+        Logic logic(&config); // Новая логика на позицию: пустые таблица транспозиций и история
+        double ms = 0;
+        for (int d = 1; d <= depth; ++d)
+        {
+            logic.Max_depth = d;
+            logic.find_turns(color, mtx);
+            if (logic.turns.empty())
+                break;
+            const auto start = chrono::steady_clock::now();
+            const string best = turns_to_string(logic.find_best_turns(mtx, color));
+            ms += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            total += logic.nodes;
+            for (const char c : best + ' ' + to_string(logic.nodes) + ' ')
+                signature = (signature ^ uint8_t(c)) * 1099511628211ull;
+            cout << "  depth " << d << ": " << best << " score " << logic.last_score << " nodes " << logic.nodes
+                 << " time " << (int)ms << " ms" << endl;
+        }
+        if (SearchStats::enabled()) // Статистика поиска на последней глубине
+            cout << "  stats " << logic.stats.to_json().dump() << endl;
+        total_ms += ms;
+    }
+    cout << "nodes " << total << " time " << (int)total_ms << " ms nps "
+         << (uint64_t)(total / max(total_ms, 1e-3) * 1000) << endl;
+    cout << "signature " << hex << signature << dec << endl;
+    return 0;
+}
+
+int tbgen(Config &config, const int pieces)
+{
+    string path = config("Bot", "TablebasePath");
+    if (path.empty())
+    {
+        cerr << "set the table folder with --Bot.TablebasePath=path/" << endl;
+        return 1;
+    }
+    filesystem::create_directories(path);
+    const auto start = chrono::steady_clock::now();
+    TablebaseGen gen;
+    uint64_t total_capped = 0;
+    gen.build(pieces, path, [&](const string &name, const uint64_t size, const uint64_t wins, const uint64_t losses,
+                                const int longest, const uint64_t capped) {
+        const double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << name << " positions " << size << " wins " << wins << " losses " << losses << " longest " << longest
+             << " capped " << capped << " time " << (int)sec << " s" << endl;
+        total_capped += capped;
+    });
+    if (total_capped)
+        cout << total_capped << " positions are longer than the table distance limit, the bot searches them" << endl;
+    return 0;
+}
+
+// Картинки игры в виде массивов байт для Game/Assets.h: программа, собранная с EMBED_TEXTURES, не читает папку Textures
+int embed()
+{
+    const string dir = project_path + "Textures/";
+    vector<string> names;
+    for (const auto &entry : filesystem::directory_iterator(dir))
+        if (entry.path().extension() == ".png")
+            names.push_back(entry.path().filename().string());
+    sort(names.begin(), names.end());
+    ofstream fout(dir + "embedded_textures.h", ios::trunc);
+    fout << "#pragma once\n// Создано командой \"cli embed\" из картинок папки Textures, не редактировать\n\n";
+    fout << "struct embedded_texture\n{\n    const char *name;\n    const unsigned char *data;\n    unsigned int size;\n};\n";
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        ifstream fin(dir + names[i], ios::binary);
+        const vector<char> data((istreambuf_iterator<char>(fin)), istreambuf_iterator<char>());
+        fout << "\nstatic const unsigned char embedded_texture_" << i << "[] = {";
+        for (size_t j = 0; j < data.size(); ++j)
+            fout << (j % 24 ? "" : "\n   ") << ' ' << int((unsigned char)data[j]) << ',';
+        fout << "\n};\n";
+        cout << names[i] << ' ' << data.size() << " bytes" << endl;
+    }
+    fout << "\nstatic const embedded_texture EMBEDDED_TEXTURES[] = {\n";
+    for (size_t i = 0; i < names.size(); ++i)
+        fout << "    {\"" << names[i] << "\", embedded_texture_" << i << ", sizeof(embedded_texture_" << i << ")},\n";
+    fout << "};\n";
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        cerr << "usage: cli <play|analyze|perft|bench|tbgen|book|embed> [--settings=path] [--games=N] [--depth=N] "
+                "[--divide] [--full] [--pieces=N] [--plies=N] [--Section.Name=value ...]"
+             << endl;
+        return 1;
+    }
+    const string command = argv[1];
+    string settings = project_path + "settings.json";
+    int games = 1;
+    int depth = 0;
+    bool divide = false;
+    bool full = false;
+    int pieces = 4;
+    int plies = 12;
+    vector<string> overrides;
+    for (int i = 2; i < argc; ++i)
+    {
+        const string arg = argv[i];
+        if (arg.rfind("--settings=", 0) == 0)
+            settings = arg.substr(11);
+        else if (arg.rfind("--games=", 0) == 0)
+            games = stoi(arg.substr(8));
+        else if (arg.rfind("--depth=", 0) == 0)
+            depth = stoi(arg.substr(8));
+        else if (arg == "--divide")
+            divide = true;
+        else if (arg == "--full")
+            full = true;
+        else if (arg.rfind("--pieces=", 0) == 0)
+            pieces = stoi(arg.substr(9));
+        else if (arg.rfind("--plies=", 0) == 0)
+            plies = stoi(arg.substr(8));
+        else
+            overrides.push_back(arg);
+    }
+
+    Config config(settings);
+    for (const auto &arg : overrides)
+    {
+        const size_t dot = arg.find('.'), eq = arg.find('=');
+        if (arg.rfind("--", 0) != 0 || dot == string::npos || eq == string::npos || dot > eq)
+        {
+            cerr << "unknown option: " << arg << endl;
+            return 1;
+        }
+        config.set(arg.substr(2, dot - 2), arg.substr(dot + 1, eq - dot - 1), arg.substr(eq + 1));
+    }
+
+    if (command == "play")
+        return play(config, games);
+    if (command == "analyze")
+        return analyze(config);
+    if (command == "perft")
+        return perft(depth, divide, full);
+    if (command == "bench")
+        return bench(config, depth > 0 ? depth : 11);
+    if (command == "tbgen")
+        return tbgen(config, min(pieces, TB_MAX_PIECES));
+    if (command == "book")
+        return build_book(config, games, plies);
+    if (command == "embed")
+        return embed();
+    cerr << "unknown command: " << command << endl;
+    return 1;
+}